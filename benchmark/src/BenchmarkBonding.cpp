@@ -0,0 +1,113 @@
+#include "BondedLink.hpp"
+#include "Loopback.hpp"
+#include <cstdio>
+#include <memory>
+
+// Measures the aggregate throughput of frames striped across bonded serial links
+static constexpr uint8_t windowSize { 4 };
+static constexpr uint8_t reorderWindow { 32 };
+static constexpr size_t frameSize { 128 };
+static constexpr size_t slotSize { 256 };
+
+template <size_t Links>
+static double run(const std::array<uint32_t, Links>& baudRates)
+{
+    using Clock = std::chrono::steady_clock;
+
+    std::atomic<bool> done { false };
+    std::atomic<bool> writing { true };
+    std::atomic<size_t> received { 0 };
+    std::vector<std::unique_ptr<Benchmark::LinkPair>> pairs;
+    for (size_t i = 0; i < Links; i++)
+        pairs.push_back(std::make_unique<Benchmark::LinkPair>(baudRates[i], windowSize, 0, slotSize, 100, 5, i * 2 + 1));
+
+    auto links = [&pairs]<size_t... I>(auto side, std::index_sequence<I...>) {
+        return std::array<std::reference_wrapper<Hdlcpp::Hdlcpp>, Links> { side(*pairs[I])... };
+    };
+
+    std::vector<Hdlcpp::value_type> buffers[4] {
+        std::vector<Hdlcpp::value_type>(slotSize * (Links + reorderWindow)), std::vector<Hdlcpp::value_type>(slotSize * reorderWindow),
+        std::vector<Hdlcpp::value_type>(slotSize * (Links + reorderWindow)), std::vector<Hdlcpp::value_type>(slotSize * reorderWindow)
+    };
+    Hdlcpp::BondedLink<Links> a(
+        links([](Benchmark::LinkPair& pair) { return std::ref(pair.a); }, std::make_index_sequence<Links>()),
+        buffers[0], buffers[1], reorderWindow);
+    Hdlcpp::BondedLink<Links> b(
+        links([](Benchmark::LinkPair& pair) { return std::ref(pair.b); }, std::make_index_sequence<Links>()),
+        buffers[2], buffers[3], reorderWindow);
+
+    std::vector<std::thread> readers;
+    for (size_t i = 0; i < Links; i++) {
+        readers.emplace_back([&, i] {
+            while (!done)
+                a.receive(i);
+        });
+        readers.emplace_back([&, i] {
+            while (!done)
+                b.receive(i);
+        });
+    }
+
+    readers.emplace_back([&] {
+        std::vector<uint8_t> data(frameSize);
+        while (!done) {
+            const auto response { b.read(data) };
+            if (response.size > 0)
+                received += response.size;
+        }
+    });
+
+    // Enough writers to fill the window of every link
+    std::vector<std::thread> writers;
+    for (size_t i = 0; i < (Links * pairs[0]->a.window()); i++) {
+        writers.emplace_back([&] {
+            std::vector<uint8_t> data(frameSize, 0x55);
+            while (writing)
+                a.write(Hdlcpp::AddressBroadcast, data);
+        });
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    const size_t start { received };
+    const auto startTime { Clock::now() };
+    std::this_thread::sleep_for(std::chrono::seconds(2));
+    const double throughput { (received - start) / std::chrono::duration<double>(Clock::now() - startTime).count() };
+
+    // Let the writers complete their frames before closing the links
+    writing = false;
+    for (auto& writer : writers)
+        writer.join();
+
+    done = true;
+    a.close();
+    b.close();
+    for (auto& pair : pairs)
+        pair->close();
+    for (auto& reader : readers)
+        reader.join();
+
+    return throughput;
+}
+
+int main()
+{
+    std::printf("%-24s %12s %10s\n", "links (baud)", "bytes/s", "scaling");
+
+    const double single { run<1>({ 115200 }) };
+    std::printf("%-24s %12.0f %10.2f\n", "115200", single, 1.0);
+
+    const double two { run<2>({ 115200, 115200 }) };
+    std::printf("%-24s %12.0f %10.2f\n", "2 x 115200", two, two / single);
+
+    const double three { run<3>({ 115200, 115200, 115200 }) };
+    std::printf("%-24s %12.0f %10.2f\n", "3 x 115200", three, three / single);
+
+    const double four { run<4>({ 115200, 115200, 115200, 115200 }) };
+    std::printf("%-24s %12.0f %10.2f\n", "4 x 115200", four, four / single);
+
+    // Links of different speeds are weighted by their measured throughput
+    const double mixed { run<2>({ 115200, 57600 }) };
+    std::printf("%-24s %12.0f %10.2f\n", "115200 + 57600", mixed, mixed / single);
+
+    return 0;
+}
@@ -0,0 +1,120 @@
+#include "Hdlcpp.hpp"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+// Measures the effective throughput of a serial link with and without compressing the data frames
+static constexpr uint32_t baudRate { 115200 };
+static constexpr size_t frameSize { 128 };
+static constexpr size_t corpusSize { 256 * 1024 };
+
+static std::vector<uint8_t> jsonCorpus(std::mt19937& random)
+{
+    static constexpr const char* sources[] = { "hdmi", "optical", "bluetooth", "line" };
+    std::string corpus;
+
+    while (corpus.size() < corpusSize) {
+        corpus += "{\"volume\":" + std::to_string(random() % 100) + ",\"mute\":" + ((random() % 2) ? "true" : "false")
+            + ",\"source\":\"" + sources[random() % 4] + "\",\"eq\":{\"bass\":" + std::to_string(static_cast<int>(random() % 13) - 6)
+            + ",\"treble\":" + std::to_string(static_cast<int>(random() % 13) - 6) + "}}";
+    }
+
+    return { corpus.begin(), corpus.begin() + corpusSize };
+}
+
+static std::vector<uint8_t> logCorpus(std::mt19937& random)
+{
+    static constexpr const char* messages[] = { "amplifier temperature nominal", "buffer underrun on stream", "link established", "volume changed" };
+    std::string corpus;
+
+    for (uint32_t timestamp = 0; corpus.size() < corpusSize; timestamp += random() % 1000) {
+        corpus += "[" + std::to_string(timestamp) + "] " + ((random() % 8) ? "info" : "warning") + ": " + messages[random() % 4] + "\n";
+    }
+
+    return { corpus.begin(), corpus.begin() + corpusSize };
+}
+
+static std::vector<uint8_t> tlvCorpus(std::mt19937& random)
+{
+    std::vector<uint8_t> corpus;
+
+    // Tag, length and a small little endian value as typical for sensor readings
+    while (corpus.size() < corpusSize) {
+        const uint16_t value = 0x200 + (random() % 64);
+        corpus.insert(corpus.end(), { static_cast<uint8_t>(random() % 8), 2, static_cast<uint8_t>(value & 0xff), static_cast<uint8_t>(value >> 8) });
+    }
+
+    corpus.resize(corpusSize);
+    return corpus;
+}
+
+static std::vector<uint8_t> randomCorpus(std::mt19937& random)
+{
+    std::vector<uint8_t> corpus(corpusSize);
+    std::generate(corpus.begin(), corpus.end(), [&random]() { return random() & 0xff; });
+
+    return corpus;
+}
+
+struct Result {
+    size_t wireBytes;
+    double writeMicroseconds;
+};
+
+static Result run(const std::vector<uint8_t>& corpus, bool compression)
+{
+    using Clock = std::chrono::steady_clock;
+
+    Result result {};
+    Hdlcpp::StaticBuffer<Hdlcpp::Calculate<frameSize>::WithOverhead> readBuffer {}, writeBuffer {};
+    Hdlcpp::StaticBuffer<Hdlcpp::Lz::WorkspaceSize> workspace {};
+    Hdlcpp::StaticBuffer<frameSize> writeCompressed {}, readCompressed {};
+
+    // Count the bytes on the wire without waiting for acks
+    Hdlcpp::Hdlcpp hdlcpp(
+        [](Hdlcpp::Container) { return 0; },
+        [&result](Hdlcpp::ConstContainer buffer) {
+            result.wireBytes += buffer.size();
+            return static_cast<int>(buffer.size());
+        },
+        readBuffer, writeBuffer, 0);
+
+    if (compression)
+        hdlcpp.enableCompression(workspace, writeCompressed, readCompressed);
+
+    const auto start { Clock::now() };
+    for (size_t i = 0; i < corpus.size(); i += frameSize)
+        hdlcpp.write(Hdlcpp::AddressBroadcast, std::span(corpus).subspan(i, frameSize));
+
+    result.writeMicroseconds = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / (corpus.size() / frameSize);
+
+    return result;
+}
+
+int main()
+{
+    std::mt19937 random(1);
+    const std::pair<const char*, std::vector<uint8_t>> corpora[] = {
+        { "json", jsonCorpus(random) },
+        { "log", logCorpus(random) },
+        { "tlv", tlvCorpus(random) },
+        { "random", randomCorpus(random) },
+    };
+
+    std::printf("%-7s %12s %12s %8s %14s %14s %10s\n", "corpus", "raw bytes", "lz bytes", "ratio", "raw B/s", "lz B/s", "lz us/frame");
+
+    for (const auto& [name, corpus] : corpora) {
+        const auto raw { run(corpus, false) };
+        const auto lz { run(corpus, true) };
+
+        // The effective throughput is the payload delivered per second at 10 bits per byte on the wire
+        std::printf("%-7s %12zu %12zu %8.2f %14.0f %14.0f %10.2f\n", name, raw.wireBytes, lz.wireBytes,
+            static_cast<double>(raw.wireBytes) / lz.wireBytes,
+            static_cast<double>(corpus.size()) * baudRate / 10 / raw.wireBytes,
+            static_cast<double>(corpus.size()) * baudRate / 10 / lz.wireBytes, lz.writeMicroseconds);
+    }
+
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include "FramePool.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+// Measures frame buffer churn from concurrent threads, each keeping a small queue of frames in flight,
+// with buffers from a FramePool versus a std::vector allocated per frame
+static constexpr size_t frameSize { Hdlcpp::Calculate<128>::WithOverhead };
+static constexpr size_t queueDepth { 8 };
+static constexpr size_t maxThreads { 8 };
+static constexpr auto duration { std::chrono::milliseconds(500) };
+
+using Pool = Hdlcpp::FramePool<frameSize, queueDepth * maxThreads>;
+
+template <typename Queue>
+static double run(size_t threadCount, Queue makeQueue)
+{
+    std::atomic<bool> done { false };
+    std::atomic<size_t> frames { 0 };
+    std::vector<std::thread> threads;
+
+    for (size_t i = 0; i < threadCount; i++) {
+        threads.emplace_back([&] {
+            auto queue { makeQueue() };
+            size_t count = 0;
+
+            for (; !done; count++)
+                queue.push(static_cast<uint8_t>(count));
+
+            frames += count;
+        });
+    }
+
+    std::this_thread::sleep_for(duration);
+    done = true;
+    for (auto& thread : threads)
+        thread.join();
+
+    return frames / std::chrono::duration<double>(duration).count();
+}
+
+// A queue holding the most recent frames, releasing the oldest frame when full
+class PoolQueue {
+public:
+    explicit PoolQueue(Pool& pool)
+        : pool(pool)
+    {
+    }
+
+    ~PoolQueue()
+    {
+        for (auto& frame : frames)
+            if (!frame.empty())
+                pool.release(frame);
+    }
+
+    void push(uint8_t value)
+    {
+        auto& frame { frames[next++ % queueDepth] };
+        if (!frame.empty())
+            pool.release(frame);
+
+        frame = pool.acquire();
+        if (!frame.empty())
+            std::memset(frame.data(), value, frame.size());
+    }
+
+    Pool& pool;
+    std::array<Hdlcpp::Container, queueDepth> frames {};
+    size_t next { 0 };
+};
+
+class VectorQueue {
+public:
+    void push(uint8_t value)
+    {
+        frames[next++ % queueDepth] = std::vector<uint8_t>(frameSize, value);
+    }
+
+    std::array<std::vector<uint8_t>, queueDepth> frames {};
+    size_t next { 0 };
+};
+
+int main()
+{
+    auto pool { std::make_unique<Pool>() };
+
+    std::printf("%-8s %16s %16s %8s\n", "threads", "pool frames/s", "vector frames/s", "peak");
+
+    for (size_t threadCount = 1; threadCount <= maxThreads; threadCount *= 2) {
+        const double pooled { run(threadCount, [&pool] { return PoolQueue(*pool); }) };
+        const double allocated { run(threadCount, [] { return VectorQueue(); }) };
+
+        std::printf("%-8zu %16.0f %16.0f %8zu\n", threadCount, pooled, allocated, pool->peak());
+    }
+
+    return 0;
+}
@@ -0,0 +1,72 @@
+#include "Loopback.hpp"
+#include <cstdio>
+
+// Measures the write latency of small control frames while a bulk writer keeps the link busy
+struct Result {
+    std::vector<double> controlLatencies;
+    std::vector<double> bulkLatencies;
+};
+
+static const char* priorityName(Hdlcpp::Priority priority)
+{
+    static constexpr const char* names[Hdlcpp::PriorityClasses] { "high", "normal", "bulk" };
+
+    return (priority < Hdlcpp::PriorityClasses) ? names[priority] : "unknown";
+}
+
+static Result run(uint8_t windowSize, Hdlcpp::Priority controlPriority, Hdlcpp::Priority bulkPriority)
+{
+    static constexpr uint32_t baudRate { 115200 };
+    static constexpr size_t controlFrames { 100 };
+    using Clock = std::chrono::steady_clock;
+
+    Result result;
+    std::mutex resultMutex;
+    std::atomic<bool> done { false };
+    Benchmark::Loopback loopback(baudRate, windowSize, {});
+
+    auto bulk = [&] {
+        std::vector<uint8_t> data(200, 0x55);
+        while (!done) {
+            const auto start { Clock::now() };
+            if (loopback.a.write(Hdlcpp::AddressBroadcast, data, bulkPriority) > 0) {
+                std::lock_guard<std::mutex> resultLock(resultMutex);
+                result.bulkLatencies.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+            }
+        }
+    };
+
+    std::vector<std::thread> bulkWriters;
+    for (uint8_t i = 0; i < loopback.a.window(bulkPriority); i++)
+        bulkWriters.emplace_back(bulk);
+
+    std::vector<uint8_t> data(4, 0xaa);
+    for (size_t i = 0; i < controlFrames; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        const auto start { Clock::now() };
+        if (loopback.a.write(Hdlcpp::AddressBroadcast, data, controlPriority) > 0)
+            result.controlLatencies.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    }
+
+    done = true;
+    for (auto& writer : bulkWriters)
+        writer.join();
+
+    return result;
+}
+
+int main()
+{
+    std::printf("%-7s %-8s %-8s %12s %12s %12s %12s\n", "window", "control", "bulk", "control p50", "control p99", "control max", "bulk p50");
+
+    for (uint8_t windowSize : { 1, 4 }) {
+        for (const auto& [control, bulk] : { std::pair(Hdlcpp::PriorityNormal, Hdlcpp::PriorityNormal), std::pair(Hdlcpp::PriorityHigh, Hdlcpp::PriorityBulk) }) {
+            const auto result { run(windowSize, control, bulk) };
+            std::printf("%-7u %-8s %-8s %10.2fms %10.2fms %10.2fms %10.2fms\n", windowSize, priorityName(control), priorityName(bulk),
+                Benchmark::percentile(result.controlLatencies, 50), Benchmark::percentile(result.controlLatencies, 99),
+                Benchmark::percentile(result.controlLatencies, 100), Benchmark::percentile(result.bulkLatencies, 50));
+        }
+    }
+
+    return 0;
+}
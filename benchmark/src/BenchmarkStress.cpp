@@ -0,0 +1,134 @@
+#include "Loopback.hpp"
+#include <cstdio>
+#include <cstring>
+
+// Measures how concurrent writers to one Hdlcpp instance scale, with a looped-back peer acknowledging
+// the frames from its reader thread. Every frame carries its writer and a per writer counter which the
+// peer verifies, so a frame corrupted or reordered by a race fails the run (also meant to run with TSan,
+// see BUILD_HDLCPP_STRESS_TSAN).
+static constexpr size_t frameSize { 16 };
+static constexpr size_t maxWriters { 64 };
+static constexpr auto duration { std::chrono::milliseconds(500) };
+
+struct Result {
+    size_t frames { 0 };
+    size_t failed { 0 };
+    size_t corrupted { 0 };
+    size_t reordered { 0 };
+    double p50 { 0 };
+    double p99 { 0 };
+    double worstP99 { 0 };
+    double fairness { 0 };
+};
+
+static void encodeFrame(std::array<uint8_t, frameSize>& data, uint8_t writer, uint32_t counter)
+{
+    data[0] = writer;
+    std::memcpy(&data[1], &counter, sizeof(counter));
+    for (size_t i = 1 + sizeof(counter); i < data.size(); i++)
+        data[i] = static_cast<uint8_t>(writer ^ counter ^ i);
+}
+
+static Result run(uint8_t windowSize, size_t writerCount)
+{
+    using Clock = std::chrono::steady_clock;
+
+    Result result;
+    std::atomic<bool> done { false };
+    // Only updated by the reader thread of the peer
+    std::array<int64_t, maxWriters> lastCounters {};
+    lastCounters.fill(-1);
+
+    std::vector<std::vector<double>> latencies(writerCount);
+    std::vector<size_t> frames(writerCount), failed(writerCount);
+
+    {
+        Benchmark::Loopback loopback(0, windowSize, [&](Hdlcpp::ReadResponse, Hdlcpp::ConstContainer data) {
+            std::array<uint8_t, frameSize> expected {};
+            uint32_t counter { 0 };
+
+            if (data.size() != frameSize) {
+                result.corrupted++;
+                return;
+            }
+
+            std::memcpy(&counter, &data[1], sizeof(counter));
+            encodeFrame(expected, data[0], counter);
+            if ((data[0] >= maxWriters) || !std::equal(data.begin(), data.end(), expected.begin())) {
+                result.corrupted++;
+                return;
+            }
+
+            // A frame might be received twice if its ack was late, but never after a later frame
+            if (counter < lastCounters[data[0]])
+                result.reordered++;
+
+            lastCounters[data[0]] = counter;
+        });
+
+        std::vector<std::thread> writers;
+        for (size_t i = 0; i < writerCount; i++) {
+            writers.emplace_back([&, i] {
+                std::array<uint8_t, frameSize> data {};
+
+                for (uint32_t counter = 0; !done; counter++) {
+                    encodeFrame(data, i, counter);
+
+                    const auto start { Clock::now() };
+                    if (loopback.a.write(Hdlcpp::AddressBroadcast, data) > 0) {
+                        latencies[i].push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+                        frames[i]++;
+                    } else {
+                        failed[i]++;
+                    }
+                }
+            });
+        }
+
+        std::this_thread::sleep_for(duration);
+        done = true;
+        for (auto& writer : writers)
+            writer.join();
+    }
+
+    // Jain's fairness index of the frames written per writer (1 if all writers got the same share)
+    double sum { 0 }, squares { 0 };
+    std::vector<double> allLatencies;
+
+    for (size_t i = 0; i < writerCount; i++) {
+        sum += frames[i];
+        squares += static_cast<double>(frames[i]) * frames[i];
+        result.frames += frames[i];
+        result.failed += failed[i];
+        result.worstP99 = std::max(result.worstP99, Benchmark::percentile(latencies[i], 99));
+        allLatencies.insert(allLatencies.end(), latencies[i].begin(), latencies[i].end());
+    }
+
+    result.fairness = (squares > 0) ? ((sum * sum) / (writerCount * squares)) : 0;
+    result.p50 = Benchmark::percentile(allLatencies, 50);
+    result.p99 = Benchmark::percentile(allLatencies, 99);
+
+    return result;
+}
+
+int main()
+{
+    bool passed { true };
+
+    std::printf("%-7s %-8s %10s %10s %10s %12s %9s %7s %9s %9s\n", "window", "writers", "frames/s", "p50", "p99", "worst p99",
+        "fairness", "failed", "corrupted", "reordered");
+
+    for (uint8_t windowSize : { 1, 4 }) {
+        for (size_t writerCount = 1; writerCount <= maxWriters; writerCount *= 2) {
+            const Result result { run(windowSize, writerCount) };
+
+            std::printf("%-7u %-8zu %10.0f %8.0fus %8.0fus %10.0fus %9.3f %7zu %9zu %9zu\n", windowSize, writerCount,
+                result.frames / std::chrono::duration<double>(duration).count(), result.p50, result.p99, result.worstP99,
+                result.fairness, result.failed, result.corrupted, result.reordered);
+
+            passed = passed && (result.corrupted == 0) && (result.reordered == 0);
+        }
+    }
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,179 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2020 Bang & Olufsen a/s
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "Hdlcpp.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace Benchmark {
+
+//! @brief A simulated serial link delivering the written bytes after their transmission time
+class SerialLink {
+public:
+    //! @param baudRate The baud rate of the link (10 bits per byte) or 0 for no transmission delay
+    //! @param lossRate The probability of a write being lost on the link
+    SerialLink(uint32_t baudRate, double lossRate = 0, uint32_t seed = 1)
+        : baudRate(baudRate)
+        , lossRate(lossRate)
+        , random(seed)
+    {
+    }
+
+    int read(Hdlcpp::Container buffer)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!condition.wait_for(lock, std::chrono::milliseconds(1), [this] { return !queue.empty() || closed; }))
+            return 0;
+
+        const size_t size { std::min(buffer.size(), queue.size()) };
+        std::copy_n(queue.begin(), size, buffer.begin());
+        queue.erase(queue.begin(), queue.begin() + size);
+
+        return size;
+    }
+
+    int write(Hdlcpp::ConstContainer buffer)
+    {
+        // The line is occupied for the transmission time of the write
+        std::lock_guard<std::mutex> lineLock(lineMutex);
+        if (baudRate > 0)
+            std::this_thread::sleep_for(std::chrono::microseconds((buffer.size() * 10 * 1000000ULL) / baudRate));
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (std::uniform_real_distribution<double>(0, 1)(random) >= lossRate) {
+            queue.insert(queue.end(), buffer.begin(), buffer.end());
+            condition.notify_all();
+        }
+
+        return buffer.size();
+    }
+
+    void close()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        condition.notify_all();
+    }
+
+private:
+    std::mutex mutex;
+    std::mutex lineMutex;
+    std::condition_variable condition;
+    std::deque<uint8_t> queue;
+    uint32_t baudRate;
+    double lossRate;
+    std::mt19937 random;
+    bool closed { false };
+};
+
+//! @brief A pair of Hdlcpp instances connected by simulated serial links
+class LinkPair {
+public:
+    LinkPair(uint32_t baudRate, uint8_t windowSize, double lossRate = 0, size_t bufferSize = 256, uint16_t writeTimeout = 100, uint8_t writeRetries = 5, uint32_t seed = 1)
+        : aToB(baudRate, lossRate, seed)
+        , bToA(baudRate, lossRate, seed + 1)
+        // The buffer size is only known at run time so add the overhead of an empty data frame to the escaped data
+        , buffers(4, std::vector<Hdlcpp::value_type>(Hdlcpp::Calculate<0>::DataFrame + (bufferSize * 2)))
+        , a([this](Hdlcpp::Container buffer) { return bToA.read(buffer); },
+              [this](Hdlcpp::ConstContainer buffer) { return aToB.write(buffer); },
+              buffers[0], buffers[1], writeTimeout, writeRetries, windowSize)
+        , b([this](Hdlcpp::Container buffer) { return aToB.read(buffer); },
+              [this](Hdlcpp::ConstContainer buffer) { return bToA.write(buffer); },
+              buffers[2], buffers[3], writeTimeout, writeRetries, windowSize)
+    {
+    }
+
+    void close()
+    {
+        a.close();
+        b.close();
+        aToB.close();
+        bToA.close();
+    }
+
+    SerialLink aToB;
+    SerialLink bToA;
+    std::vector<std::vector<Hdlcpp::value_type>> buffers;
+    Hdlcpp::Hdlcpp a;
+    Hdlcpp::Hdlcpp b;
+};
+
+//! @brief A pair of Hdlcpp instances connected by simulated serial links with a reader thread each
+class Loopback : public LinkPair {
+public:
+    using Receive = std::function<void(Hdlcpp::ReadResponse response, Hdlcpp::ConstContainer data)>;
+
+    Loopback(uint32_t baudRate, uint8_t windowSize, Receive receive, double lossRate = 0, size_t bufferSize = 256, uint16_t writeTimeout = 100, uint8_t writeRetries = 5)
+        : LinkPair(baudRate, windowSize, lossRate, bufferSize, writeTimeout, writeRetries)
+    {
+        readers.emplace_back([this] { readLoop(a, {}); });
+        readers.emplace_back([this, receive] { readLoop(b, receive); });
+    }
+
+    ~Loopback()
+    {
+        stopped = true;
+        close();
+
+        for (auto& reader : readers)
+            reader.join();
+    }
+
+private:
+    void readLoop(Hdlcpp::Hdlcpp& hdlcpp, const Receive& receive)
+    {
+        std::vector<uint8_t> data(buffers[0].size());
+
+        while (!stopped) {
+            const auto response { hdlcpp.read(data) };
+            if ((response.size > 0) && receive)
+                receive(response, Hdlcpp::ConstContainer(data).first(response.size));
+        }
+    }
+
+    std::atomic<bool> stopped { false };
+    std::vector<std::thread> readers;
+};
+
+//! @brief Returns the given percentile of the samples
+template <typename T>
+T percentile(std::vector<T> samples, double percent)
+{
+    if (samples.empty())
+        return {};
+
+    const size_t index { std::min(samples.size() - 1, static_cast<size_t>(samples.size() * percent / 100)) };
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+
+    return samples[index];
+}
+
+} // namespace Benchmark
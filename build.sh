@@ -8,6 +8,7 @@ help() {
   echo "  -m               Build hdlcpp main"
   echo "  -t               Run tests"
   echo "  -o               Run coverage"
+  echo "  -r               Run benchmarks"
   echo "  -e               Build build environment"
   echo "  -c               Clean build"
   echo "  -s               Create a Docker shell"
@@ -19,12 +20,13 @@ if [ $# -eq 0 ]; then
   help
 fi
 
-while getopts "bmtoecsh" option; do
+while getopts "bmtorecsh" option; do
   case $option in
     b) scripts/docker_shell.sh scripts/build_x86.sh ;;
     m) scripts/docker_shell.sh scripts/build_main.sh ;;
     t) scripts/docker_shell.sh scripts/run_tests.sh ;;
     o) scripts/docker_shell.sh scripts/coverage.sh ;;
+    r) scripts/docker_shell.sh scripts/run_benchmarks.sh ;;
     e) scripts/build_buildenv.sh ;;
     s) scripts/docker_shell.sh ;;
     c) scripts/clean.sh ;;
@@ -0,0 +1,350 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2020 Bang & Olufsen a/s
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "Hdlcpp.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <limits>
+#include <mutex>
+
+namespace Hdlcpp {
+
+//! @brief Stripes frames across several links and delivers them in order at the receiver (like MLPPP)
+//! @details Each frame is prefixed with a 16-bit sequence number and sent on the link expected to
+//!          complete it first, based on the bytes queued on each link and its measured throughput. A
+//!          frame failing on a link is sent on the other links. The receiver buffers frames arriving
+//!          out of order within the reorder window, and the sender never has frames outstanding
+//!          beyond it. A frame missing while later frames (buffered or waiting for the reorder window to move)
+//!          wait for longer than the loss timeout is skipped.
+//! @param Links The number of links
+template <size_t Links>
+class BondedLink {
+    static_assert((Links > 0) && (Links <= 8), "The links tried for a frame are tracked in 8 bits");
+
+public:
+    //! @brief Constructs the BondedLink instance
+    //! @param links The Hdlcpp instances of the links (the BondedLink must be their only reader and writer)
+    //! @param readBuffer Buffer split into a frame slot per link and per frame of the reorder window
+    //! @param writeBuffer Buffer split into a frame slot per frame of the reorder window
+    //! @param reorderWindow The number of frames buffered for resequencing (must match the peer), rounded down to a
+    //!                      power of two of at most 64 so the slots of a sequence number are continuous across its wrap
+    //! @param lossTimeout The time in milliseconds to wait for a missing frame while later frames are buffered
+    //!                    (should exceed the time for a link to give up on a frame, i.e. writeTimeout * (writeRetries + 1))
+    BondedLink(std::array<std::reference_wrapper<Hdlcpp>, Links> links, Container readBuffer, Container writeBuffer, uint8_t reorderWindow = 8, uint16_t lossTimeout = 1000)
+        : links(links)
+        , readBuffer(readBuffer)
+        , writeBuffer(writeBuffer)
+        , reorderWindow(std::bit_floor(std::clamp<uint8_t>(reorderWindow, 1, MaxReorderWindow)))
+        , lossTimeout(lossTimeout)
+    {
+        readSizes.fill(-1);
+        readWaiting.fill(-1);
+    }
+
+    //! @brief Destructs the BondedLink instance
+    virtual ~BondedLink() = default;
+
+    //! @brief Reads a frame from a link into the reorder window (blocks if TransportRead is blocking)
+    //! @details Must be called continuously by a thread per link to receive frames and acknowledges
+    //! @param link The index of the link
+    //! @return The number of bytes received if positive or an error code from <cerrno>
+    virtual ReadResponse receive(size_t link)
+    {
+        const size_t slotSize { readSlotSize() };
+
+        if ((link >= Links) || (slotSize <= HeaderSize))
+            return { -EINVAL, AddressBroadcast };
+
+        const auto linkBuffer { readBuffer.subspan(link * slotSize, slotSize) };
+        const auto response { links[link].get().read(linkBuffer) };
+        if (response.size <= 0)
+            return response;
+
+        if (response.size <= static_cast<int>(HeaderSize))
+            return { -EPROTO, response.address };
+
+        const uint16_t sequenceNumber = linkBuffer[0] | (linkBuffer[1] << 8);
+        const auto data { linkBuffer.subspan(HeaderSize, response.size - HeaderSize) };
+
+        std::unique_lock<std::mutex> readLock(readMutex);
+
+        // Wait for the frame to fit within the reorder window, the reader skips frames lost meanwhile
+        readWaiting[link] = sequenceNumber;
+        readCondition.wait(readLock, [&] {
+            return stopped || (static_cast<int16_t>(sequenceNumber - readSequenceNumber) < reorderWindow);
+        });
+        readWaiting[link] = -1;
+
+        // Drop frames already delivered or skipped (e.g. sent on another link after a lost ack)
+        const uint8_t slot = sequenceNumber % reorderWindow;
+        if (stopped || (static_cast<int16_t>(sequenceNumber - readSequenceNumber) < 0) || (readSizes[slot] >= 0))
+            return { 0, response.address };
+
+        std::copy(data.begin(), data.end(), reorderSlot(slot).begin());
+        readSizes[slot] = data.size();
+        readAddresses[slot] = response.address;
+        readBuffered++;
+        readLock.unlock();
+
+        readCondition.notify_all();
+
+        return { static_cast<int>(data.size()), response.address };
+    }
+
+    //! @brief Reads the next frame in order (blocks until it has been received or the BondedLink is closed)
+    //! @param buffer Buffer for storing the frame
+    //! @return The number of bytes read if positive or an error code from <cerrno>
+    virtual ReadResponse read(Container buffer)
+    {
+        auto deadline { std::chrono::steady_clock::now() + std::chrono::milliseconds(lossTimeout) };
+
+        if (!buffer.data() || buffer.empty())
+            return { -EINVAL, AddressBroadcast };
+
+        std::unique_lock<std::mutex> readLock(readMutex);
+        uint8_t slot = readSequenceNumber % reorderWindow;
+
+        while (readSizes[slot] < 0) {
+            if (stopped)
+                return { 0, AddressBroadcast };
+
+            // Later frames are either buffered or waiting in receive() for the reorder window to move
+            const int16_t waiting { readWaitingOffset() };
+            const auto now { std::chrono::steady_clock::now() };
+            if ((readBuffered == 0) && (waiting == std::numeric_limits<int16_t>::max())) {
+                deadline = now + std::chrono::milliseconds(lossTimeout);
+            } else if ((now >= deadline) && (waiting >= reorderWindow)) {
+                // The missing frame is considered lost as later frames have been waiting for it
+                readSequenceNumber++;
+                slot = readSequenceNumber % reorderWindow;
+                readCondition.notify_all();
+                continue;
+            }
+
+            readCondition.wait_for(readLock, std::chrono::milliseconds(1));
+        }
+
+        const int size { readSizes[slot] };
+        const TransportAddress address { readAddresses[slot] };
+        const auto data { reorderSlot(slot).first(size) };
+        const bool fits { size <= static_cast<int>(buffer.size()) };
+
+        if (fits)
+            std::copy(data.begin(), data.end(), buffer.begin());
+
+        readSizes[slot] = -1;
+        readBuffered--;
+        readSequenceNumber++;
+        readLock.unlock();
+
+        readCondition.notify_all();
+
+        return { fits ? size : -EMSGSIZE, address };
+    }
+
+    //! @brief Writes a frame on the link expected to complete it first (thread safe)
+    //! @param address Address of the receiver
+    //! @param buffer Buffer storing the data to be sent
+    //! @param priority The priority class of the data frame
+    //! @return The number of bytes sent if positive or an error code from <cerrno>
+    virtual int write(TransportAddress address, ConstContainer buffer, Priority priority = PriorityNormal)
+    {
+        int result { -EIO };
+        uint16_t sequenceNumber;
+        uint8_t tried { 0 };
+        const size_t slotSize { writeBuffer.size() / reorderWindow };
+
+        if (!buffer.data() || buffer.empty() || (slotSize <= HeaderSize))
+            return -EINVAL;
+
+        if ((buffer.size() + HeaderSize) > slotSize)
+            return -EMSGSIZE;
+
+        {
+            std::unique_lock<std::mutex> writeLock(writeMutex);
+
+            // The receiver can buffer the frames from the oldest one not yet completed and onwards
+            writeCondition.wait(writeLock, [this] { return static_cast<uint16_t>(writeSequenceNumber - writeOldest) < reorderWindow; });
+            sequenceNumber = writeSequenceNumber++;
+            writePending[sequenceNumber % reorderWindow] = true;
+        }
+
+        const auto frame { writeBuffer.subspan((sequenceNumber % reorderWindow) * slotSize, HeaderSize + buffer.size()) };
+        frame[0] = sequenceNumber & 0xff;
+        frame[1] = (sequenceNumber >> 8) & 0xff;
+        std::copy(buffer.begin(), buffer.end(), frame.begin() + HeaderSize);
+
+        for (size_t attempt = 0; (attempt < Links) && (result <= 0); attempt++) {
+            size_t link;
+            std::chrono::steady_clock::time_point start;
+            {
+                std::lock_guard<std::mutex> writeLock(writeMutex);
+                link = selectLink(frame.size(), tried);
+                linkQueued[link] += frame.size();
+                start = std::chrono::steady_clock::now();
+            }
+
+            result = links[link].get().write(address, frame, priority);
+
+            std::lock_guard<std::mutex> writeLock(writeMutex);
+            linkQueued[link] -= frame.size();
+            if (result > 0) {
+                measure(link, frame.size(), start);
+            } else {
+                // Prefer the other links until the link has proven itself again
+                tried |= (1 << link);
+                linkRates[link] = std::max<uint32_t>(linkRates[link] / 4, 1);
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> writeLock(writeMutex);
+            writePending[sequenceNumber % reorderWindow] = false;
+            while ((writeOldest != writeSequenceNumber) && !writePending[writeOldest % reorderWindow])
+                writeOldest++;
+        }
+
+        writeCondition.notify_all();
+
+        return (result > 0) ? static_cast<int>(buffer.size()) : result;
+    }
+
+    //! @brief Returns the measured throughput of a link in bytes per second (0 if not measured yet)
+    uint32_t rate(size_t link) const
+    {
+        return (link < Links) ? linkRates[link] : 0;
+    }
+
+    //! @brief Closes the reading of the BondedLink and its links
+    virtual void close()
+    {
+        {
+            std::lock_guard<std::mutex> readLock(readMutex);
+            stopped = true;
+        }
+
+        readCondition.notify_all();
+        for (auto& link : links)
+            link.get().close();
+    }
+
+protected:
+    size_t readSlotSize() const
+    {
+        return readBuffer.size() / (Links + reorderWindow);
+    }
+
+    //! @brief Returns the offset from readSequenceNumber of the first frame waiting in receive(), or the
+    //!        maximum if none is waiting (a frame within the reorder window is about to be buffered)
+    int16_t readWaitingOffset() const
+    {
+        int16_t offset { std::numeric_limits<int16_t>::max() };
+
+        for (const auto& sequenceNumber : readWaiting) {
+            if (sequenceNumber >= 0)
+                offset = std::min<int16_t>(offset, static_cast<int16_t>(sequenceNumber - readSequenceNumber));
+        }
+
+        return offset;
+    }
+
+    Container reorderSlot(uint8_t slot) const
+    {
+        return readBuffer.subspan((Links + slot) * readSlotSize(), readSlotSize() - HeaderSize);
+    }
+
+    size_t selectLink(size_t size, uint8_t tried) const
+    {
+        size_t selected { Links };
+        uint64_t maxRate { 1 };
+
+        // Links not measured yet are assumed to be as fast as the fastest link
+        for (size_t i = 0; i < Links; i++)
+            maxRate = std::max<uint64_t>(maxRate, linkRates[i]);
+
+        for (size_t i = 0; i < Links; i++) {
+            if (tried & (1 << i))
+                continue;
+
+            if (selected == Links) {
+                selected = i;
+                continue;
+            }
+
+            // Compare the expected completion times (queued bytes / rate) without dividing
+            const uint64_t rate { linkRates[i] ? linkRates[i] : maxRate };
+            const uint64_t selectedRate { linkRates[selected] ? linkRates[selected] : maxRate };
+            if (((linkQueued[i] + size) * selectedRate) < ((linkQueued[selected] + size) * rate))
+                selected = i;
+        }
+
+        return selected;
+    }
+
+    void measure(size_t link, size_t size, std::chrono::steady_clock::time_point start)
+    {
+        const auto now { std::chrono::steady_clock::now() };
+
+        // The service time excludes the time spent queued behind the previous frame on the link
+        const auto microseconds { std::chrono::duration_cast<std::chrono::microseconds>(now - std::max(start, linkCompleted[link])).count() };
+        const uint32_t sample = (size * 1000000ULL) / std::max<int64_t>(microseconds, 1);
+
+        linkRates[link] = (linkRates[link] == 0) ? sample : ((linkRates[link] * 7ULL + sample) / 8);
+        linkCompleted[link] = now;
+    }
+
+    static constexpr size_t HeaderSize { 2 };
+    static constexpr uint8_t MaxReorderWindow { 64 };
+    static_assert(std::has_single_bit(MaxReorderWindow), "The reorder window must divide the 16-bit sequence number space");
+
+    std::mutex readMutex;
+    std::condition_variable readCondition;
+    std::mutex writeMutex;
+    std::condition_variable writeCondition;
+    std::array<std::reference_wrapper<Hdlcpp>, Links> links;
+    Container readBuffer;
+    Container writeBuffer;
+    uint8_t reorderWindow;
+    uint16_t lossTimeout;
+    uint16_t readSequenceNumber { 0 };
+    uint8_t readBuffered { 0 };
+    std::array<int, MaxReorderWindow> readSizes {};
+    std::array<TransportAddress, MaxReorderWindow> readAddresses {};
+    // The sequence number of the frame each link is waiting to fit in the reorder window or -1
+    std::array<int32_t, Links> readWaiting {};
+    uint16_t writeSequenceNumber { 0 };
+    uint16_t writeOldest { 0 };
+    std::array<bool, MaxReorderWindow> writePending {};
+    std::array<size_t, Links> linkQueued {};
+    std::array<uint32_t, Links> linkRates {};
+    std::array<std::chrono::steady_clock::time_point, Links> linkCompleted {};
+    bool stopped { false };
+};
+
+} // namespace Hdlcpp
@@ -0,0 +1,159 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2020 Bang & Olufsen a/s
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "Hdlcpp.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <functional>
+
+namespace Hdlcpp {
+
+//! @brief Decodes the frames of a raw capture of a link (e.g. a UART dump) without a transport
+//! @details A flag sequence never occurs inside a frame, so a capture split at flag sequences can be
+//!          decoded in parts independently (e.g. on several threads) with the same result as a
+//!          whole. Each part must include the flag sequence it ends at, as it closes its last frame.
+class CaptureDecoder : protected Hdlcpp {
+public:
+    using Frame = Hdlcpp::Frame;
+
+    //! @brief A frame found in the capture
+    struct Record {
+        //! The offset of the opening flag sequence in the capture
+        uint64_t offset;
+        //! The number of bytes from the opening to the closing flag sequence (both included)
+        uint32_t length;
+        //! The payload size if positive or -EIO (FCS error or too short) or -EMSGSIZE (payload too large)
+        int status;
+        TransportAddress address;
+        //! The frame type (0 data, 1 ack, 2 nack, 3 rnr, 4 srej and 5 compressed data)
+        Frame frame;
+        uint8_t sequenceNumber;
+        //! The payload (empty unless status is positive)
+        std::span<const value_type> data;
+    };
+
+    //! @brief Receives the frames of the capture in order
+    using Sink = std::function<void(const Record& record)>;
+
+    //! @brief Constructs the CaptureDecoder instance
+    //! @param payloadBuffer Buffer for the payload of a frame (larger payloads are reported with -EMSGSIZE)
+    explicit CaptureDecoder(Container payloadBuffer)
+        : Hdlcpp([](Container) { return -EIO; }, [](ConstContainer) { return -EIO; }, {}, {})
+        , payloadBuffer(payloadBuffer)
+    {
+    }
+
+    //! @brief Finds where a part of the capture can start without splitting a frame
+    //! @param capture The complete capture
+    //! @param offset The offset to search from
+    //! @return The offset of the first flag sequence at or after the given offset that opens a frame (the
+    //!         last of consecutive flag sequences like in decode()), or the capture size if there is none
+    static size_t boundary(ConstContainer capture, size_t offset)
+    {
+        if (offset >= capture.size())
+            return capture.size();
+
+        auto flag { std::find(capture.begin() + offset, capture.end(), FlagSequence) };
+        while ((flag != capture.end()) && ((flag + 1) != capture.end()) && (*(flag + 1) == FlagSequence))
+            flag++;
+
+        return flag - capture.begin();
+    }
+
+    //! @brief Decodes the frames of a part of the capture
+    //! @param capture The part of the capture (a frame not closed at its end is left for the next part)
+    //! @param offset The offset of the part in the capture, added to the offsets of the records
+    //! @param sink The sink receiving a record per frame
+    //! @return The number of frames
+    size_t decodeFrames(ConstContainer capture, uint64_t offset, const Sink& sink)
+    {
+        size_t frames = 0, position = 0;
+
+        while (position < capture.size()) {
+            const size_t start = boundary(capture, position);
+            const size_t remaining = capture.size() - start;
+            if (remaining == 0)
+                break;
+
+            // decode() does not modify the source and its indices are 16-bit
+            const Container source { const_cast<value_type*>(capture.data()) + start, std::min<size_t>(remaining, MaxSourceSize) };
+            TransportAddress address = 0;
+            Frame frame = FrameData;
+            uint8_t sequenceNumber = 0;
+            uint16_t discardBytes = 0;
+            int result = decode(address, frame, sequenceNumber, source, payloadBuffer, discardBytes);
+            size_t length = discardBytes + 1;
+
+            if (result == -ENOMSG) {
+                // The last frame is not closed, unless it is too large for decode()
+                if (source.size() == remaining)
+                    break;
+
+                const size_t stop = boundary(capture, start + 1);
+                if (stop == capture.size())
+                    break;
+
+                length = stop - start + 1;
+                result = -EMSGSIZE;
+            }
+
+            sink({ offset + start, static_cast<uint32_t>(length), result, address, frame, sequenceNumber,
+                (result > 0) ? payloadBuffer.first(result) : ConstContainer {} });
+            frames++;
+
+            // The closing flag sequence opens the next frame
+            position = start + length - 1;
+        }
+
+        return frames;
+    }
+
+    //! @brief Gets a name of a frame type for printing
+    static const char* frameName(Frame frame)
+    {
+        switch (frame) {
+        case FrameData:
+            return "data";
+        case FrameAck:
+            return "ack";
+        case FrameNack:
+            return "nack";
+        case FrameReceiveNotReady:
+            return "rnr";
+        case FrameSelectiveReject:
+            return "srej";
+        case FrameCompressedData:
+            return "compressed";
+        }
+
+        return "unknown";
+    }
+
+protected:
+    static constexpr size_t MaxSourceSize { 0xffff };
+
+    Container payloadBuffer;
+};
+
+} // namespace Hdlcpp
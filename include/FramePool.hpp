@@ -0,0 +1,141 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2020 Bang & Olufsen a/s
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "Hdlcpp.hpp"
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+
+namespace Hdlcpp {
+
+//! @brief A fixed-capacity pool of frame buffers that never allocates (e.g. for queued or in-flight frames)
+//! @details The free buffers are kept in a lock-free list, so buffers can be acquired and released from
+//!          any thread without locking. The head of the list is tagged with a counter which is changed
+//!          by every update, so a buffer released and acquired again in between is detected.
+//! @param FrameSize The size of each buffer (e.g. Calculate<Capacity>::WithOverhead for an encoded frame)
+//! @param Frames The number of buffers
+template <size_t FrameSize, size_t Frames>
+class FramePool {
+    static_assert((FrameSize > 0) && (Frames > 0) && (Frames < 0xffffffff), "The buffers are indexed in 32 bits");
+
+public:
+    //! @brief Constructs the FramePool instance with all buffers free
+    FramePool()
+    {
+        for (uint32_t i = 0; i < Frames; i++)
+            links[i].store(i + 1, std::memory_order_relaxed);
+    }
+
+    //! @brief Acquires a buffer (thread safe)
+    //! @return The buffer, or an empty buffer if all buffers are in use
+    Container acquire()
+    {
+        uint64_t head { freeHead.load(std::memory_order_acquire) };
+        uint32_t index;
+
+        do {
+            index = static_cast<uint32_t>(head);
+            if (index == Empty) {
+                exhaustedCount.fetch_add(1, std::memory_order_relaxed);
+                return {};
+            }
+        } while (!freeHead.compare_exchange_weak(head, tagged(head, links[index].load(std::memory_order_relaxed)),
+            std::memory_order_acquire, std::memory_order_acquire));
+
+        // Counted once acquired (and uncounted before it is released) so the count never exceeds the buffers in use
+        const size_t inUse { usedCount.fetch_add(1, std::memory_order_relaxed) + 1 };
+        size_t peak { peakCount.load(std::memory_order_relaxed) };
+        while ((inUse > peak) && !peakCount.compare_exchange_weak(peak, inUse, std::memory_order_relaxed))
+            ;
+
+        return { storage.data() + (static_cast<size_t>(index) * FrameSize), FrameSize };
+    }
+
+    //! @brief Releases a buffer acquired from the pool (thread safe, a buffer must only be released once)
+    //! @param buffer The buffer returned by acquire (or a part of it starting at its beginning)
+    //! @return Zero on success or an error code from <cerrno>
+    int release(Container buffer)
+    {
+        // Compared as addresses as the buffer might not be from the pool
+        const uintptr_t offset { reinterpret_cast<uintptr_t>(buffer.data()) - reinterpret_cast<uintptr_t>(storage.data()) };
+
+        if (!buffer.data() || (offset >= storage.size()) || ((offset % FrameSize) != 0))
+            return -EINVAL;
+
+        const uint32_t index { static_cast<uint32_t>(offset / FrameSize) };
+        uint64_t head { freeHead.load(std::memory_order_relaxed) };
+
+        usedCount.fetch_sub(1, std::memory_order_relaxed);
+
+        do {
+            links[index].store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+        } while (!freeHead.compare_exchange_weak(head, tagged(head, index), std::memory_order_release, std::memory_order_relaxed));
+
+        return 0;
+    }
+
+    //! @brief Returns the number of buffers in the pool
+    static constexpr size_t capacity()
+    {
+        return Frames;
+    }
+
+    //! @brief Returns the number of buffers in use
+    //! @details While buffers are acquired and released concurrently it may lag behind, but it never exceeds
+    //!          the number of buffers actually in use
+    size_t used() const
+    {
+        return usedCount.load(std::memory_order_relaxed);
+    }
+
+    //! @brief Returns the highest number of buffers in use at the same time (never more than were actually in use)
+    size_t peak() const
+    {
+        return peakCount.load(std::memory_order_relaxed);
+    }
+
+    //! @brief Returns the number of times a buffer could not be acquired as all buffers were in use
+    size_t exhausted() const
+    {
+        return exhaustedCount.load(std::memory_order_relaxed);
+    }
+
+protected:
+    static uint64_t tagged(uint64_t head, uint32_t index)
+    {
+        return (((head >> 32) + 1) << 32) | index;
+    }
+
+    static constexpr uint32_t Empty { Frames };
+
+    StaticBuffer<FrameSize * Frames> storage {};
+    std::array<std::atomic<uint32_t>, Frames> links {};
+    std::atomic<uint64_t> freeHead { 0 };
+    std::atomic<size_t> usedCount { 0 };
+    std::atomic<size_t> peakCount { 0 };
+    std::atomic<size_t> exhaustedCount { 0 };
+};
+
+} // namespace Hdlcpp
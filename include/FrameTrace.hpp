@@ -0,0 +1,161 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2020 Bang & Olufsen a/s
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <span>
+
+namespace Hdlcpp {
+
+//! @brief Records timestamped frame events of an Hdlcpp instance in a fixed-size ring (see Hdlcpp::enableTrace)
+//! @details The transmitted and received frames are recorded in a half of the slots each, as the transmit
+//!          path is serialized and a single thread reads. Recording neither locks nor allocates and
+//!          overwrites the oldest events. The trace can be dumped at any time from any thread.
+class FrameTrace {
+public:
+    enum Direction : uint8_t {
+        DirectionTransmit,
+        DirectionReceive,
+    };
+
+    //! @brief A frame event
+    struct Event {
+        //! The steady clock time in nanoseconds
+        uint64_t timestamp;
+        //! The payload size
+        uint16_t length;
+        //! Zero if the frame was sent or received correctly or an error code from <cerrno> (e.g. -EIO for an FCS error)
+        int16_t result;
+        uint8_t address;
+        //! The control byte (as decoded for a received frame)
+        uint8_t control;
+        Direction direction;
+        //! The number of retransmissions of a transmitted data frame
+        uint8_t retry;
+    };
+
+    //! @brief Storage of an event, protected by a sequence number so it is never dumped while being overwritten
+    struct Slot {
+        std::atomic<uint64_t> sequence { 0 };
+        std::atomic<uint64_t> timestamp { 0 };
+        std::atomic<uint64_t> frame { 0 };
+    };
+
+    //! @brief Constructs the FrameTrace instance
+    //! @param slots Storage split into a half for transmitted and a half for received frames (at least 2 slots)
+    explicit FrameTrace(std::span<Slot> slots)
+        : rings { slots.first(slots.size() / 2), slots.subspan(slots.size() / 2) }
+    {
+    }
+
+    //! @brief Records a frame event (only a single thread may record each direction at a time)
+    void record(Direction direction, uint8_t address, uint8_t control, uint16_t length, int result, uint8_t retry = 0)
+    {
+        const std::span<Slot> ring { rings[direction] };
+        if (ring.empty())
+            return;
+
+        const uint64_t index { heads[direction].load(std::memory_order_relaxed) };
+        Slot& slot { ring[index % ring.size()] };
+        const auto timestamp { std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()) };
+
+        // Invalidate the slot before overwriting it (a dump reading the new values sees the invalidation)
+        slot.sequence.store(0, std::memory_order_relaxed);
+        slot.timestamp.store(timestamp.count(), std::memory_order_release);
+        slot.frame.store(length | (static_cast<uint64_t>(static_cast<uint16_t>(result)) << 16) | (static_cast<uint64_t>(address) << 32)
+                | (static_cast<uint64_t>(control) << 40) | (static_cast<uint64_t>(retry) << 48),
+            std::memory_order_release);
+        slot.sequence.store(index + 1, std::memory_order_release);
+        heads[direction].store(index + 1, std::memory_order_release);
+    }
+
+    //! @brief Copies the most recent events in chronological order
+    //! @param events Buffer for the events
+    //! @return The number of events copied
+    size_t dump(std::span<Event> events) const
+    {
+        std::array<uint64_t, 2> next { heads[DirectionTransmit].load(std::memory_order_acquire), heads[DirectionReceive].load(std::memory_order_acquire) };
+        std::array<Event, 2> pending {};
+        std::array<bool, 2> available {};
+        size_t count = 0;
+
+        // Merge the two rings from the newest events backwards, until an event has been overwritten
+        const auto fetch = [&](Direction direction) {
+            available[direction] = (next[direction] > 0) && load(direction, next[direction] - 1, pending[direction]);
+            next[direction] = available[direction] ? (next[direction] - 1) : 0;
+        };
+
+        fetch(DirectionTransmit);
+        fetch(DirectionReceive);
+
+        while ((count < events.size()) && (available[DirectionTransmit] || available[DirectionReceive])) {
+            const Direction direction { (available[DirectionTransmit]
+                                            && (!available[DirectionReceive] || (pending[DirectionTransmit].timestamp >= pending[DirectionReceive].timestamp)))
+                    ? DirectionTransmit
+                    : DirectionReceive };
+
+            events[events.size() - ++count] = pending[direction];
+            fetch(direction);
+        }
+
+        std::copy(events.end() - count, events.end(), events.begin());
+
+        return count;
+    }
+
+    //! @brief Returns the number of events recorded since the start (including overwritten events)
+    uint64_t recorded() const
+    {
+        return heads[DirectionTransmit].load(std::memory_order_relaxed) + heads[DirectionReceive].load(std::memory_order_relaxed);
+    }
+
+protected:
+    bool load(Direction direction, uint64_t index, Event& event) const
+    {
+        const Slot& slot { rings[direction][index % rings[direction].size()] };
+
+        if (slot.sequence.load(std::memory_order_acquire) != (index + 1))
+            return false;
+
+        const uint64_t timestamp { slot.timestamp.load(std::memory_order_acquire) };
+        const uint64_t frame { slot.frame.load(std::memory_order_acquire) };
+
+        // The slot has been overwritten while reading it
+        if (slot.sequence.load(std::memory_order_relaxed) != (index + 1))
+            return false;
+
+        event = { timestamp, static_cast<uint16_t>(frame), static_cast<int16_t>(frame >> 16), static_cast<uint8_t>(frame >> 32),
+            static_cast<uint8_t>(frame >> 40), direction, static_cast<uint8_t>(frame >> 48) };
+
+        return true;
+    }
+
+    std::array<std::span<Slot>, 2> rings;
+    std::array<std::atomic<uint64_t>, 2> heads {};
+};
+
+} // namespace Hdlcpp
@@ -22,9 +22,14 @@
 
 #pragma once
 
+#include "FrameTrace.hpp"
+#include "Lz.hpp"
+
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <cerrno>
+#include <condition_variable>
 #include <functional>
 #include <mutex>
 #include <span>
@@ -111,7 +116,14 @@ using StaticBuffer = std::array<Container::value_type, Capacity>;
 template <size_t Capacity>
 struct Calculate {
     // For details see: https://en.wikipedia.org/wiki/High-Level_Data_Link_Control#Structure
-    static constexpr size_t WithOverhead { Capacity * 2 + 8 };
+    // Flag, address, control, data, FCS and flag, where the address, data and FCS bytes might be escaped.
+    // The control byte is never escaped as the encoded control bytes never equal a flag or control escape.
+    static constexpr size_t DataFrame { 1 + 2 + 1 + (Capacity * 2) + 4 + 1 };
+    // No supervisory frame has both an escaped address and two escaped FCS bytes (verified by the tests)
+    static constexpr size_t SupervisoryFrame { 1 + 2 + 1 + 3 + 1 };
+    static constexpr size_t WithOverhead { DataFrame };
+    // Zero-bit insertion adds at most a bit per five bits of address, control, data and FCS
+    static constexpr size_t WithSyncOverhead { (((Capacity + 4) * 8 * 6 / 5) + 16 + 7) / 8 };
 };
 
 using TransportRead = std::function<int(Container buffer)>;
@@ -120,6 +132,15 @@ using TransportWrite = std::function<int(ConstContainer buffer)>;
 using TransportAddress = uint8_t;
 static constexpr TransportAddress AddressBroadcast { 0xff };
 
+//! @brief The priority class of a write, a frame of a higher class is sent at the next frame boundary
+enum Priority : uint8_t {
+    PriorityHigh,
+    PriorityNormal,
+    PriorityBulk,
+};
+
+static constexpr uint8_t PriorityClasses { 3 };
+
 struct ReadResponse {
     const int size;
     const TransportAddress address;
@@ -133,7 +154,8 @@ public:
     //! @param write A std::function for writing to the transport layer (e.g. UART)
     //! @param writeTimeout The write timeout in milliseconds to wait for an ack/nack
     //! @param writeRetries The number of write retries in case of timeout
-    Hdlcpp(TransportRead read, TransportWrite write, Container readBuffer, Container writeBuffer, uint16_t writeTimeout = 100, uint8_t writeRetries = 1)
+    //! @param windowSize The number of frames allowed in flight (1 for stop-and-wait, must match the peer)
+    Hdlcpp(TransportRead read, TransportWrite write, Container readBuffer, Container writeBuffer, uint16_t writeTimeout = 100, uint8_t writeRetries = 1, uint8_t windowSize = 1)
         : transportRead(std::move(read))
         , transportWrite(std::move(write))
         , readBuffer(readBuffer)
@@ -141,6 +163,7 @@ public:
         , readFrame(FrameNack)
         , writeTimeout(writeTimeout)
         , writeRetries(writeRetries)
+        , windowSize(std::clamp<uint8_t>(windowSize, 1, MaxWindowSize))
     {
     }
 
@@ -155,16 +178,23 @@ public:
     {
         int result;
         TransportAddress address { AddressBroadcast };
+        uint8_t sequenceNumber { 0 };
         uint16_t discardBytes;
 
         if (!buffer.data() || buffer.empty() || (buffer.size() > readBuffer.capacity()))
             return { -EINVAL, address };
 
         do {
+            // Let the peer resume sending once the backlog in the readBuffer has been consumed
+            if (receiveNotReadySent && !receiveBusy && !readBufferCongested()) {
+                receiveNotReadySent = false;
+                writeFrame(receiveNotReadyAddress, FrameAck, readSequenceNumber, {});
+            }
+
             bool doTransportRead { true };
             if (!readBuffer.empty()) {
                 // Try to decode the readBuffer before potentially blocking in the transportRead
-                result = decode(address, readFrame, readSequenceNumber, readBuffer.dataSpan(), buffer, discardBytes);
+                result = decode(address, readFrame, sequenceNumber, readBuffer.dataSpan(), buffer, discardBytes);
                 if (result >= 0) {
                     doTransportRead = false;
                 } else if (readBuffer.unusedSpan().size() == 0) {
@@ -181,27 +211,52 @@ public:
                     return { result, address };
 
                 readBuffer.appendToTail(result);
-                result = decode(address, readFrame, readSequenceNumber, readBuffer.dataSpan(), buffer, discardBytes);
+                result = decode(address, readFrame, sequenceNumber, readBuffer.dataSpan(), buffer, discardBytes);
             }
 
             if (discardBytes > 0) {
                 readBuffer.erase(readBuffer.begin(), readBuffer.begin() + discardBytes);
+
+                if (frameTrace)
+                    frameTrace->record(FrameTrace::DirectionReceive, address, encodeControlByte(readFrame, sequenceNumber),
+                        std::max(result, 0), std::min(result, 0));
             }
 
             if (result >= 0) {
                 switch (readFrame) {
                 case FrameData:
-                    if (++readSequenceNumber > 7)
-                        readSequenceNumber = 0;
-                    writeFrame(address, FrameAck, readSequenceNumber, {});
-                    return { result, address };
+                case FrameCompressedData:
+                    // Decompressed before the frame is acknowledged so a corrupted payload is requested again.
+                    // Without compression enabled the receive sequence number is ignored as before.
+                    if ((readFrame == FrameCompressedData) && !compressionWorkspace.empty() && ((result = decompress(buffer, result)) < 0)) {
+                        if (result == -EIO)
+                            rejectFrame(address, sequenceNumber);
+                        break;
+                    }
+
+                    if (receiveData(address, sequenceNumber))
+                        return { result, address };
+
+                    // The data frame was discarded (duplicate or busy)
+                    result = 0;
+                    break;
                 case FrameAck:
+                case FrameReceiveNotReady:
+                    acknowledgeWrites(sequenceNumber);
+                    writeResult = readFrame;
+                    break;
                 case FrameNack:
+                    rejectWrites();
+                    writeResult = readFrame;
+                    break;
+                case FrameSelectiveReject:
+                    if (writeOutstanding & (1 << sequenceNumber))
+                        writeStates[sequenceNumber] = FrameSelectiveReject;
                     writeResult = readFrame;
                     break;
                 }
-            } else if ((result == -EIO) && (readFrame == FrameData)) {
-                writeFrame(address, FrameNack, readSequenceNumber, {});
+            } else if ((result == -EIO) && ((readFrame == FrameData) || (readFrame == FrameCompressedData))) {
+                rejectFrame(address, sequenceNumber);
             }
         } while (!stopped);
 
@@ -209,48 +264,188 @@ public:
     }
 
     //! @brief Writes data to be encoded and sent to the transport layer (thread safe)
+    //! @details While the peer signals Receive Not Ready the write is paused without
+    //!          counting it as a retry, until the peer is ready or the instance is closed
     //! @param address Address of the receiver
     //! @param buffer Buffer storing the data to be sent
+    //! @param priority The priority class of the data frame
     //! @return The number of bytes sent if positive or an error code from <cerrno>
-    virtual int write(TransportAddress address, ConstContainer buffer)
+    virtual int write(TransportAddress address, ConstContainer buffer, Priority priority = PriorityNormal)
     {
         int result;
 
-        if (!buffer.data() || buffer.empty())
+        if ((result = writeAsync(address, buffer, priority)) < 0)
+            return result;
+
+        return writeWait(result);
+    }
+
+    //! @brief Sends a data frame without waiting for it to be acknowledged (thread safe)
+    //! @details Allows pipelining up to window(priority) frames. The buffer must stay valid
+    //!          until writeWait has been called with the returned sequence number
+    //! @param address Address of the receiver
+    //! @param buffer Buffer storing the data to be sent
+    //! @param priority The priority class of the data frame
+    //! @return The sequence number to pass to writeWait if positive or an error code from <cerrno>
+    virtual int writeAsync(TransportAddress address, ConstContainer buffer, Priority priority = PriorityNormal)
+    {
+        int result;
+        uint8_t sequenceNumber;
+
+        if (!buffer.data() || buffer.empty() || (priority >= PriorityClasses))
             return -EINVAL;
 
-        std::lock_guard<std::mutex> writeLock(writeMutex);
+        {
+            std::unique_lock<std::mutex> writeLock(writeMutex);
+            const uint32_t ticket { writeTickets[priority]++ };
+            const auto deadline { std::chrono::steady_clock::now() + std::chrono::milliseconds(writeTimeout) };
+
+            // Wait in order of arrival within the class for the next sequence number to fit within the
+            // window. Queued higher priority classes go first, bounded by the write timeout.
+            while ((ticket != writeServing[priority]) || !writeWindowAvailable(priority)
+                || (writeQueuedHigherPriority(priority) && (std::chrono::steady_clock::now() < deadline)))
+                writeCondition.wait_for(writeLock, std::chrono::milliseconds(1));
+
+            writeServing[priority]++;
+            writeReserved++;
+        }
+
+        writeCondition.notify_all();
+
+        if ((result = writePause()) < 0) {
+            std::lock_guard<std::mutex> writeLock(writeMutex);
+            writeReserved--;
+            return result;
+        }
+
+        // The sequence number is assigned at the frame boundary so frames are sent in order
+        transmitAcquire(priority);
+        {
+            std::lock_guard<std::mutex> writeLock(writeMutex);
+            writeReserved--;
+
+            // Sequence number is a 3-bit value
+            if (++writeSequenceNumber > 7)
+                writeSequenceNumber = 0;
+
+            sequenceNumber = writeSequenceNumber;
+            writeSlots[sequenceNumber] = { address, priority, buffer };
+            writeStates[sequenceNumber] = -1;
+            writeRetransmissions[sequenceNumber] = 0;
+            writeOutstanding |= (1 << sequenceNumber);
+        }
+        result = transmit(address, FrameData, sequenceNumber, buffer);
+        transmitRelease();
+
+        if (result <= 0) {
+            writeOutstanding &= ~(1 << sequenceNumber);
+            writeCondition.notify_all();
+            // Nothing written must not be mistaken for sequence number 0
+            return (result < 0) ? result : -EIO;
+        }
+
+        return sequenceNumber;
+    }
 
-        // Sequence number is a 3-bit value
-        if (++writeSequenceNumber > 7)
-            writeSequenceNumber = 0;
+    //! @brief Waits for a data frame sent by writeAsync to be acknowledged and retransmits it if needed
+    //! @param sequenceNumber The sequence number returned by writeAsync
+    //! @return The number of bytes sent if positive or an error code from <cerrno>
+    virtual int writeWait(uint8_t sequenceNumber)
+    {
+        int result { 0 };
+        bool retransmit { false };
+
+        if (!(writeOutstanding & (1 << sequenceNumber)))
+            return -EINVAL;
 
         for (uint8_t tries = 0; tries <= writeRetries; tries++) {
-            writeResult = -1;
-            if ((result = writeFrame(address, FrameData, writeSequenceNumber, buffer)) <= 0)
+            if (retransmit && ((result = writeSlot(sequenceNumber)) <= 0))
                 break;
 
-            if (writeTimeout == 0)
+            retransmit = true;
+            if (writeTimeout == 0) {
+                result = writeSlots[sequenceNumber].buffer.size();
                 break;
+            }
 
             for (uint16_t i = 0; i < writeTimeout; i++) {
-                result = writeResult;
-                if (result >= 0) {
-                    if (result == FrameNack)
-                        break;
-
-                    return buffer.size();
-                }
+                if ((result = writeStates[sequenceNumber]) >= 0)
+                    break;
 
                 std::this_thread::sleep_for(std::chrono::milliseconds(1));
             }
 
+            if (result == FrameAck) {
+                result = writeSlots[sequenceNumber].buffer.size();
+                break;
+            }
+
+            // A busy peer discards the frame so it should not count as a retry
+            if ((result < 0) && (writeResult == FrameReceiveNotReady))
+                tries--;
+
             result = -ETIME;
         }
 
+        writeOutstanding &= ~(1 << sequenceNumber);
+        writeCondition.notify_all();
+
         return result;
     }
 
+    //! @brief Signals the peer to pause or resume sending data frames (Receive Not Ready/Receive Ready)
+    //! @param address Address of the peer
+    //! @param busy True to pause the peer or false to let it resume
+    //! @return The number of bytes sent if positive or an error code from <cerrno>
+    virtual int setBusy(TransportAddress address, bool busy)
+    {
+        receiveBusy = busy;
+        receiveNotReadySent = false;
+
+        return writeFrame(address, busy ? FrameReceiveNotReady : FrameAck, readSequenceNumber, {});
+    }
+
+    //! @brief Enables compressing data frames which get smaller by it (must be enabled at the peer as well)
+    //! @details Each data frame is flagged as compressed or not so incompressible data is sent as is.
+    //!          Must be called before reading or writing and the buffers must stay valid
+    //! @param workspace Working memory for the compression hash table (see Lz::WorkspaceSize)
+    //! @param writeCompressed Buffer for compressing a data frame (the size of the largest data frame)
+    //! @param readCompressed Buffer for decompressing a data frame (the size of the largest data frame)
+    virtual void enableCompression(Container workspace, Container writeCompressed, Container readCompressed)
+    {
+        compressionWorkspace = workspace;
+        compressionWriteBuffer = writeCompressed;
+        compressionReadBuffer = readCompressed;
+    }
+
+    //! @brief Enables pausing the peer with RNR while more than half of the readBuffer is waiting to be decoded
+    //! @details Only enable it if the peer handles RNR, as versions without RNR take it for a NACK and retransmit.
+    //!          Must be called before reading or writing
+    virtual void enableCongestionControl()
+    {
+        congestionControl = true;
+    }
+
+    //! @brief Enables recording the transmitted and received frames in a trace
+    //! @details Must be called before reading or writing and the trace must stay valid
+    //! @param trace The trace recording the frames
+    virtual void enableTrace(FrameTrace& trace)
+    {
+        frameTrace = &trace;
+    }
+
+    //! @brief Returns the number of data frames allowed in flight for a priority class
+    //! @details With a windowSize above 1 the highest class has a frame in flight reserved so it is never
+    //!          queued behind the others. Stop-and-wait keeps a single frame in flight for all classes,
+    //!          so the highest class only goes first at the next frame boundary
+    uint8_t window(Priority priority = PriorityNormal) const
+    {
+        if ((priority == PriorityHigh) || (windowSize == 1))
+            return windowSize;
+
+        return windowSize - 1;
+    }
+
     //! @brief Closes the reading
     virtual void close()
     {
@@ -262,6 +457,9 @@ protected:
         FrameData,
         FrameAck,
         FrameNack,
+        FrameReceiveNotReady,
+        FrameSelectiveReject,
+        FrameCompressedData,
     };
 
     enum Control {
@@ -271,6 +469,8 @@ protected:
         ControlSFrameTypeBit2,
         ControlPollBit,
         ControlReceiveSeqNumberBit,
+        // The receive sequence number of an I-frame is not used so its lowest bit flags a compressed payload
+        ControlCompressedBit = ControlReceiveSeqNumberBit,
     };
 
     enum ControlType {
@@ -280,6 +480,28 @@ protected:
         ControlTypeSelectiveReject,
     };
 
+    //! @brief A supervisory frame encoded in advance (see supervisoryFrame)
+    struct SupervisoryFrame {
+        std::array<value_type, Calculate<0>::SupervisoryFrame> data;
+        uint8_t size;
+    };
+
+    //! @brief The supervisory frames of each type and sequence number for an address (see supervisoryFrameIndex)
+    using SupervisoryFrames = std::array<SupervisoryFrame, (FrameSelectiveReject - FrameAck + 1) * 8>;
+
+    //! @brief A supervisory frame for an address other than broadcast, encoded on first use (see supervisoryFrame)
+    struct CachedSupervisoryFrame {
+        SupervisoryFrame frame;
+        // The address the frame is encoded for or -1 if it has not been encoded yet
+        int16_t address { -1 };
+    };
+
+    struct WriteSlot {
+        TransportAddress address;
+        Priority priority;
+        std::span<const value_type> buffer;
+    };
+
     template <typename T>
     struct span {
         constexpr span(std::span<T> span)
@@ -306,7 +528,12 @@ protected:
         typename std::span<T>::iterator itr;
     };
 
-    int encode(TransportAddress address, Frame& frame, uint8_t& sequenceNumber, ConstContainer source, Hdlcpp::span<uint8_t> destination)
+    virtual int encode(TransportAddress address, Frame& frame, uint8_t& sequenceNumber, ConstContainer source, Hdlcpp::span<uint8_t> destination)
+    {
+        return encodeFrame(address, frame, sequenceNumber, source, destination);
+    }
+
+    static constexpr int encodeFrame(TransportAddress address, Frame frame, uint8_t sequenceNumber, std::span<const value_type> source, Hdlcpp::span<uint8_t> destination)
     {
         uint8_t value = 0;
         uint16_t i, fcs16Value = Fcs16InitValue;
@@ -323,7 +550,7 @@ protected:
         if (escape(value, destination) < 0)
             return -EINVAL;
 
-        if (frame == FrameData) {
+        if ((frame == FrameData) || (frame == FrameCompressedData)) {
             if (!source.data() || source.empty())
                 return -EINVAL;
 
@@ -349,7 +576,7 @@ protected:
         return destination.size();
     }
 
-    int decode(TransportAddress& address, Frame& frame, uint8_t& sequenceNumber, const Container source, Container destination, uint16_t& discardBytes) const
+    virtual int decode(TransportAddress& address, Frame& frame, uint8_t& sequenceNumber, const Container source, Container destination, uint16_t& discardBytes) const
     {
         uint8_t value = 0;
         bool controlEscape = false;
@@ -401,7 +628,10 @@ protected:
                     } else if (i == controlByteIndex) {
                         decodeControlByte(value, frame, sequenceNumber);
                     } else if (i > controlByteIndex) {
-                        destination[destinationIndex++] = value;
+                        // Keep counting to detect data not fitting the destination (the trailing FCS is not needed)
+                        if (destinationIndex < static_cast<int>(destination.size()))
+                            destination[destinationIndex] = value;
+                        destinationIndex++;
                     }
                 }
             }
@@ -415,6 +645,8 @@ protected:
             // A frame is at least 4 bytes in size and has a valid FCS value
             if ((frameStopIndex >= (frameStartIndex + 4)) && (fcs16Value == Fcs16GoodValue)) {
                 result = destinationIndex - sizeof(fcs16Value);
+                if (result > static_cast<int>(destination.size()))
+                    result = -EMSGSIZE;
             } else {
                 result = -EIO;
             }
@@ -425,17 +657,278 @@ protected:
         return result;
     }
 
-    int writeFrame(TransportAddress address, Frame frame, uint8_t sequenceNumber, ConstContainer data)
+    static constexpr SupervisoryFrames encodeSupervisoryFrames(TransportAddress address)
+    {
+        SupervisoryFrames frames {};
+
+        for (uint8_t i = 0; i < frames.size(); i++) {
+            SupervisoryFrame& encoded { frames[i] };
+            // The buffer fits the largest supervisory frame so encoding can not fail
+            encoded.size = encodeFrame(address, static_cast<Frame>(FrameAck + (i / 8)), i % 8, {}, { encoded.data });
+        }
+
+        return frames;
+    }
+
+    static constexpr uint8_t supervisoryFrameIndex(Frame frame, uint8_t sequenceNumber)
+    {
+        return ((frame - FrameAck) * 8) + (sequenceNumber & 0x7);
+    }
+
+    //! @brief Returns a supervisory frame encoded in advance, as it only depends on the address, type and sequence number
+    //! @details The frames for the broadcast address are encoded at compile time. A frame for another address is
+    //!          encoded when it is first sent and kept until the same type and sequence number is sent to yet
+    //!          another address, so alternating between peers costs at most the encoding of the frame sent.
+    //!          Must only be called while transmitting
+    //! @return The encoded frame, or an empty frame for a data frame (which must be encoded)
+    virtual std::span<const value_type> supervisoryFrame(TransportAddress address, Frame frame, uint8_t sequenceNumber)
+    {
+        if ((frame < FrameAck) || (frame > FrameSelectiveReject))
+            return {};
+
+        const uint8_t index { supervisoryFrameIndex(frame, sequenceNumber) };
+        if (address == AddressBroadcast)
+            return std::span(BroadcastSupervisoryFrames[index].data).first(BroadcastSupervisoryFrames[index].size);
+
+        CachedSupervisoryFrame& cached { supervisoryFrameCache[index] };
+        if (cached.address != address) {
+            // The buffer fits the largest supervisory frame so encoding can not fail
+            cached.frame.size = encodeFrame(address, frame, sequenceNumber & 0x7, {}, { cached.frame.data });
+            cached.address = address;
+        }
+
+        return std::span(cached.frame.data).first(cached.frame.size);
+    }
+
+    int writeFrame(TransportAddress address, Frame frame, uint8_t sequenceNumber, ConstContainer data, Priority priority = PriorityHigh)
     {
         int result;
 
-        if ((result = encode(address, frame, sequenceNumber, data, { writeBuffer })) < 0)
+        transmitAcquire(priority);
+        result = transmit(address, frame, sequenceNumber, data);
+        transmitRelease();
+
+        return result;
+    }
+
+    int transmit(TransportAddress address, Frame frame, uint8_t sequenceNumber, ConstContainer data)
+    {
+        int result;
+        std::span<const value_type> payload { data };
+        const uint8_t retry { (frame == FrameData) ? writeRetransmissions[sequenceNumber] : uint8_t(0) };
+        const std::span<const value_type> encoded { supervisoryFrame(address, frame, sequenceNumber) };
+
+        if (!encoded.empty()) {
+            // Sent as encoded in advance so the writeBuffer is left to the data frames
+            payload = {};
+            result = transportWrite(encoded);
+        } else {
+            // The compression buffers are only used while transmitting so they need no further locking
+            if ((frame == FrameData) && !compressionWorkspace.empty() && (data.size() > 1)) {
+                // Only send the compressed payload if it is smaller
+                const size_t size { std::min(data.size() - 1, compressionWriteBuffer.size()) };
+                if ((result = Lz::compress(data, compressionWriteBuffer.first(size), compressionWorkspace)) > 0) {
+                    frame = FrameCompressedData;
+                    payload = compressionWriteBuffer.first(result);
+                }
+            }
+
+            if ((result = encode(address, frame, sequenceNumber, payload, { writeBuffer })) < 0)
+                return result;
+
+            result = transportWrite(std::span(writeBuffer).first(result));
+        }
+
+        if (frameTrace)
+            frameTrace->record(FrameTrace::DirectionTransmit, address, encodeControlByte(frame, sequenceNumber), payload.size(),
+                std::min(result, 0), retry);
+
+        return result;
+    }
+
+    void transmitAcquire(Priority priority)
+    {
+        std::unique_lock<std::mutex> transmitLock(transmitMutex);
+        const auto deadline { std::chrono::steady_clock::now() + std::chrono::milliseconds(writeTimeout) };
+
+        // Give way at the frame boundary to higher priority frames waiting for the transport. The
+        // delay is bounded by the write timeout so a lower priority class can not be starved.
+        transmitWaiting[priority]++;
+        while (transmitting || (transmitWaitingHigherPriority(priority) && (std::chrono::steady_clock::now() < deadline)))
+            transmitCondition.wait_for(transmitLock, std::chrono::milliseconds(1));
+
+        transmitWaiting[priority]--;
+        transmitting = true;
+    }
+
+    void transmitRelease()
+    {
+        {
+            std::lock_guard<std::mutex> transmitLock(transmitMutex);
+            transmitting = false;
+        }
+
+        transmitCondition.notify_all();
+    }
+
+    int writePause()
+    {
+        if (stopped && (writeResult == FrameReceiveNotReady))
+            return -EBUSY;
+
+        // Pause while the peer is busy, the frame is sent anyway after the timeout to poll the peer
+        for (uint16_t i = 0; (i < writeTimeout) && (writeResult == FrameReceiveNotReady); i++)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        return 0;
+    }
+
+    int writeSlot(uint8_t sequenceNumber)
+    {
+        int result;
+        const WriteSlot& slot = writeSlots[sequenceNumber];
+
+        if ((result = writePause()) < 0)
             return result;
 
-        return transportWrite(std::span(writeBuffer).first(result));
+        writeStates[sequenceNumber] = -1;
+        writeRetransmissions[sequenceNumber]++;
+
+        return writeFrame(slot.address, FrameData, sequenceNumber, slot.buffer, slot.priority);
+    }
+
+    bool receiveData(TransportAddress address, uint8_t sequenceNumber)
+    {
+        if (receiveBusy) {
+            // Discard the frame and tell the peer to retransmit from the next expected frame once we are ready
+            writeFrame(address, FrameReceiveNotReady, readSequenceNumber, {});
+            return false;
+        }
+
+        if (windowSize == 1) {
+            readSequenceNumber = (sequenceNumber + 1) & 0x7;
+        } else {
+            const uint8_t offset = (sequenceNumber - readSequenceNumber) & 0x7;
+
+            if ((offset >= windowSize) || (receiveMask & (1 << sequenceNumber))) {
+                // Already delivered (e.g. the ack was lost) so repeat the ack or the missing frame request
+                writeFrame(address, receiveMask ? FrameSelectiveReject : FrameAck, readSequenceNumber, {});
+                return false;
+            }
+
+            // Selectively reject only the frames missing in front of an out of order frame
+            for (uint8_t i = readSequenceNumber; i != sequenceNumber; i = (i + 1) & 0x7) {
+                if (!(rejectMask & (1 << i))) {
+                    rejectMask |= (1 << i);
+                    writeFrame(address, FrameSelectiveReject, i, {});
+                }
+            }
+
+            receiveMask |= (1 << sequenceNumber);
+            while (receiveMask & (1 << readSequenceNumber)) {
+                receiveMask &= ~(1 << readSequenceNumber);
+                rejectMask &= ~(1 << readSequenceNumber);
+                readSequenceNumber = (readSequenceNumber + 1) & 0x7;
+            }
+
+            // Out of order frames are acknowledged together with the missing frames
+            if (offset > 0)
+                return true;
+        }
+
+        if (congestionControl && readBufferCongested()) {
+            // Acknowledge the frame but ask the peer to pause until the readBuffer has been consumed
+            receiveNotReadySent = true;
+            receiveNotReadyAddress = address;
+            writeFrame(address, FrameReceiveNotReady, readSequenceNumber, {});
+        } else {
+            writeFrame(address, FrameAck, readSequenceNumber, {});
+        }
+
+        return true;
+    }
+
+    void rejectFrame(TransportAddress address, uint8_t sequenceNumber)
+    {
+        if (windowSize > 1) {
+            // The sequence number of a corrupted frame can not be trusted so request the next expected
+            writeFrame(address, FrameSelectiveReject, readSequenceNumber, {});
+        } else {
+            writeFrame(address, FrameNack, sequenceNumber, {});
+        }
+    }
+
+    void acknowledgeWrites(uint8_t sequenceNumber)
+    {
+        // An acknowledge with sequence number N acknowledges all outstanding frames before N
+        for (uint8_t i = 0; i < writeStates.size(); i++) {
+            const uint8_t offset = (sequenceNumber - i) & 0x7;
+            if ((writeOutstanding & (1 << i)) && (offset > 0) && (offset <= windowSize))
+                writeStates[i] = FrameAck;
+        }
+    }
+
+    void rejectWrites()
+    {
+        // A reject requests all outstanding frames to be retransmitted
+        for (uint8_t i = 0; i < writeStates.size(); i++) {
+            if (writeOutstanding & (1 << i))
+                writeStates[i] = FrameNack;
+        }
+    }
+
+    bool writeWindowAvailable(Priority priority = PriorityNormal) const
+    {
+        // Frames reserved in the window get their sequence numbers when they are sent
+        const uint8_t sequenceNumber = (writeSequenceNumber + writeReserved + 1) & 0x7;
+
+        if (writeReserved >= window(priority))
+            return false;
+
+        for (uint8_t i = 0; i < writeStates.size(); i++) {
+            if ((writeOutstanding & (1 << i)) && (((sequenceNumber - i) & 0x7) >= window(priority)))
+                return false;
+        }
+
+        return true;
+    }
+
+    bool writeQueuedHigherPriority(Priority priority) const
+    {
+        for (uint8_t i = 0; i < priority; i++) {
+            if (writeTickets[i] != writeServing[i])
+                return true;
+        }
+
+        return false;
+    }
+
+    bool transmitWaitingHigherPriority(Priority priority) const
+    {
+        for (uint8_t i = 0; i < priority; i++) {
+            if (transmitWaiting[i] > 0)
+                return true;
+        }
+
+        return false;
     }
 
-    int escape(uint8_t value, Hdlcpp::span<uint8_t>& destination) const
+    int decompress(Container buffer, int size)
+    {
+        if (size > static_cast<int>(compressionReadBuffer.size()))
+            return -EMSGSIZE;
+
+        std::copy_n(buffer.begin(), size, compressionReadBuffer.begin());
+
+        return Lz::decompress(compressionReadBuffer.first(size), buffer);
+    }
+
+    bool readBufferCongested()
+    {
+        return readBuffer.dataSpan().size() > (readBuffer.capacity() / 2);
+    }
+
+    static constexpr int escape(uint8_t value, Hdlcpp::span<uint8_t>& destination)
     {
         if ((value == FlagSequence) || (value == ControlEscape)) {
             if (!destination.push_back(ControlEscape))
@@ -449,7 +942,7 @@ protected:
         return 0;
     }
 
-    static uint8_t encodeControlByte(Frame frame, uint8_t sequenceNumber)
+    static constexpr uint8_t encodeControlByte(Frame frame, uint8_t sequenceNumber)
     {
         uint8_t value = 0;
 
@@ -460,17 +953,35 @@ protected:
             value |= (sequenceNumber << ControlSendSeqNumberBit);
             value |= (1 << ControlPollBit);
             break;
+        case FrameCompressedData:
+            // Create the HDLC I-frame control byte with Poll bit and compressed bit set
+            value |= (sequenceNumber << ControlSendSeqNumberBit);
+            value |= (1 << ControlPollBit);
+            value |= (1 << ControlCompressedBit);
+            break;
         case FrameAck:
             // Create the HDLC Receive Ready S-frame control byte with Poll bit cleared
             value |= (sequenceNumber << ControlReceiveSeqNumberBit);
             value |= (1 << ControlSFrameBit);
             break;
         case FrameNack:
-            // Create the HDLC Receive Ready S-frame control byte with Poll bit cleared
+            // Create the HDLC Reject S-frame control byte with Poll bit cleared
             value |= (sequenceNumber << ControlReceiveSeqNumberBit);
             value |= (ControlTypeReject << ControlSFrameTypeBit);
             value |= (1 << ControlSFrameBit);
             break;
+        case FrameReceiveNotReady:
+            // Create the HDLC Receive Not Ready S-frame control byte with Poll bit cleared
+            value |= (sequenceNumber << ControlReceiveSeqNumberBit);
+            value |= (ControlTypeReceiveNotReady << ControlSFrameTypeBit);
+            value |= (1 << ControlSFrameBit);
+            break;
+        case FrameSelectiveReject:
+            // Create the HDLC Selective Reject S-frame control byte with Poll bit cleared
+            value |= (sequenceNumber << ControlReceiveSeqNumberBit);
+            value |= (ControlTypeSelectiveReject << ControlSFrameTypeBit);
+            value |= (1 << ControlSFrameBit);
+            break;
         }
 
         return value;
@@ -480,75 +991,114 @@ protected:
     {
         // Check if the frame is a S-frame
         if ((value >> ControlSFrameBit) & 0x1) {
-            // Check if S-frame type is a Receive Ready (ACK)
-            if (((value >> ControlSFrameTypeBit) & 0x3) == ControlTypeReceiveReady) {
+            switch ((value >> ControlSFrameTypeBit) & 0x3) {
+            case ControlTypeReceiveReady:
                 frame = FrameAck;
-            } else {
-                // Assume it is an NACK since Receive Not Ready, Selective Reject and U-frames are not supported
+                break;
+            case ControlTypeReceiveNotReady:
+                frame = FrameReceiveNotReady;
+                break;
+            case ControlTypeSelectiveReject:
+                frame = FrameSelectiveReject;
+                break;
+            default:
+                // Assume it is an NACK since U-frames are not supported
                 frame = FrameNack;
+                break;
             }
 
             // Add the 3-bit receive sequence number from the S-frame
             sequenceNumber = (value >> ControlReceiveSeqNumberBit) & 0x7;
         } else {
             // It must be an I-frame so add the 3-bit send sequence number (receive sequence number is not used)
-            frame = FrameData;
+            frame = ((value >> ControlCompressedBit) & 0x1) ? FrameCompressedData : FrameData;
             sequenceNumber = (value >> ControlSendSeqNumberBit) & 0x7;
         }
     }
 
-    static uint16_t fcs16(uint16_t fcs16Value, uint8_t value)
-    {
-        static constexpr uint16_t fcs16ValueTable[256] = { 0x0000, 0x1189, 0x2312, 0x329b,
-            0x4624, 0x57ad, 0x6536, 0x74bf, 0x8c48, 0x9dc1, 0xaf5a, 0xbed3, 0xca6c,
-            0xdbe5, 0xe97e, 0xf8f7, 0x1081, 0x0108, 0x3393, 0x221a, 0x56a5, 0x472c,
-            0x75b7, 0x643e, 0x9cc9, 0x8d40, 0xbfdb, 0xae52, 0xdaed, 0xcb64, 0xf9ff,
-            0xe876, 0x2102, 0x308b, 0x0210, 0x1399, 0x6726, 0x76af, 0x4434, 0x55bd,
-            0xad4a, 0xbcc3, 0x8e58, 0x9fd1, 0xeb6e, 0xfae7, 0xc87c, 0xd9f5, 0x3183,
-            0x200a, 0x1291, 0x0318, 0x77a7, 0x662e, 0x54b5, 0x453c, 0xbdcb, 0xac42,
-            0x9ed9, 0x8f50, 0xfbef, 0xea66, 0xd8fd, 0xc974, 0x4204, 0x538d, 0x6116,
-            0x709f, 0x0420, 0x15a9, 0x2732, 0x36bb, 0xce4c, 0xdfc5, 0xed5e, 0xfcd7,
-            0x8868, 0x99e1, 0xab7a, 0xbaf3, 0x5285, 0x430c, 0x7197, 0x601e, 0x14a1,
-            0x0528, 0x37b3, 0x263a, 0xdecd, 0xcf44, 0xfddf, 0xec56, 0x98e9, 0x8960,
-            0xbbfb, 0xaa72, 0x6306, 0x728f, 0x4014, 0x519d, 0x2522, 0x34ab, 0x0630,
-            0x17b9, 0xef4e, 0xfec7, 0xcc5c, 0xddd5, 0xa96a, 0xb8e3, 0x8a78, 0x9bf1,
-            0x7387, 0x620e, 0x5095, 0x411c, 0x35a3, 0x242a, 0x16b1, 0x0738, 0xffcf,
-            0xee46, 0xdcdd, 0xcd54, 0xb9eb, 0xa862, 0x9af9, 0x8b70, 0x8408, 0x9581,
-            0xa71a, 0xb693, 0xc22c, 0xd3a5, 0xe13e, 0xf0b7, 0x0840, 0x19c9, 0x2b52,
-            0x3adb, 0x4e64, 0x5fed, 0x6d76, 0x7cff, 0x9489, 0x8500, 0xb79b, 0xa612,
-            0xd2ad, 0xc324, 0xf1bf, 0xe036, 0x18c1, 0x0948, 0x3bd3, 0x2a5a, 0x5ee5,
-            0x4f6c, 0x7df7, 0x6c7e, 0xa50a, 0xb483, 0x8618, 0x9791, 0xe32e, 0xf2a7,
-            0xc03c, 0xd1b5, 0x2942, 0x38cb, 0x0a50, 0x1bd9, 0x6f66, 0x7eef, 0x4c74,
-            0x5dfd, 0xb58b, 0xa402, 0x9699, 0x8710, 0xf3af, 0xe226, 0xd0bd, 0xc134,
-            0x39c3, 0x284a, 0x1ad1, 0x0b58, 0x7fe7, 0x6e6e, 0x5cf5, 0x4d7c, 0xc60c,
-            0xd785, 0xe51e, 0xf497, 0x8028, 0x91a1, 0xa33a, 0xb2b3, 0x4a44, 0x5bcd,
-            0x6956, 0x78df, 0x0c60, 0x1de9, 0x2f72, 0x3efb, 0xd68d, 0xc704, 0xf59f,
-            0xe416, 0x90a9, 0x8120, 0xb3bb, 0xa232, 0x5ac5, 0x4b4c, 0x79d7, 0x685e,
-            0x1ce1, 0x0d68, 0x3ff3, 0x2e7a, 0xe70e, 0xf687, 0xc41c, 0xd595, 0xa12a,
-            0xb0a3, 0x8238, 0x93b1, 0x6b46, 0x7acf, 0x4854, 0x59dd, 0x2d62, 0x3ceb,
-            0x0e70, 0x1ff9, 0xf78f, 0xe606, 0xd49d, 0xc514, 0xb1ab, 0xa022, 0x92b9,
-            0x8330, 0x7bc7, 0x6a4e, 0x58d5, 0x495c, 0x3de3, 0x2c6a, 0x1ef1, 0x0f78 };
-
-        return (fcs16Value >> 8) ^ fcs16ValueTable[(fcs16Value ^ value) & 0xff];
+    static constexpr uint16_t fcs16(uint16_t fcs16Value, uint8_t value)
+    {
+        return (fcs16Value >> 8) ^ Fcs16ValueTable[(fcs16Value ^ value) & 0xff];
     }
 
+    static constexpr uint16_t Fcs16ValueTable[256] = { 0x0000, 0x1189, 0x2312, 0x329b,
+        0x4624, 0x57ad, 0x6536, 0x74bf, 0x8c48, 0x9dc1, 0xaf5a, 0xbed3, 0xca6c,
+        0xdbe5, 0xe97e, 0xf8f7, 0x1081, 0x0108, 0x3393, 0x221a, 0x56a5, 0x472c,
+        0x75b7, 0x643e, 0x9cc9, 0x8d40, 0xbfdb, 0xae52, 0xdaed, 0xcb64, 0xf9ff,
+        0xe876, 0x2102, 0x308b, 0x0210, 0x1399, 0x6726, 0x76af, 0x4434, 0x55bd,
+        0xad4a, 0xbcc3, 0x8e58, 0x9fd1, 0xeb6e, 0xfae7, 0xc87c, 0xd9f5, 0x3183,
+        0x200a, 0x1291, 0x0318, 0x77a7, 0x662e, 0x54b5, 0x453c, 0xbdcb, 0xac42,
+        0x9ed9, 0x8f50, 0xfbef, 0xea66, 0xd8fd, 0xc974, 0x4204, 0x538d, 0x6116,
+        0x709f, 0x0420, 0x15a9, 0x2732, 0x36bb, 0xce4c, 0xdfc5, 0xed5e, 0xfcd7,
+        0x8868, 0x99e1, 0xab7a, 0xbaf3, 0x5285, 0x430c, 0x7197, 0x601e, 0x14a1,
+        0x0528, 0x37b3, 0x263a, 0xdecd, 0xcf44, 0xfddf, 0xec56, 0x98e9, 0x8960,
+        0xbbfb, 0xaa72, 0x6306, 0x728f, 0x4014, 0x519d, 0x2522, 0x34ab, 0x0630,
+        0x17b9, 0xef4e, 0xfec7, 0xcc5c, 0xddd5, 0xa96a, 0xb8e3, 0x8a78, 0x9bf1,
+        0x7387, 0x620e, 0x5095, 0x411c, 0x35a3, 0x242a, 0x16b1, 0x0738, 0xffcf,
+        0xee46, 0xdcdd, 0xcd54, 0xb9eb, 0xa862, 0x9af9, 0x8b70, 0x8408, 0x9581,
+        0xa71a, 0xb693, 0xc22c, 0xd3a5, 0xe13e, 0xf0b7, 0x0840, 0x19c9, 0x2b52,
+        0x3adb, 0x4e64, 0x5fed, 0x6d76, 0x7cff, 0x9489, 0x8500, 0xb79b, 0xa612,
+        0xd2ad, 0xc324, 0xf1bf, 0xe036, 0x18c1, 0x0948, 0x3bd3, 0x2a5a, 0x5ee5,
+        0x4f6c, 0x7df7, 0x6c7e, 0xa50a, 0xb483, 0x8618, 0x9791, 0xe32e, 0xf2a7,
+        0xc03c, 0xd1b5, 0x2942, 0x38cb, 0x0a50, 0x1bd9, 0x6f66, 0x7eef, 0x4c74,
+        0x5dfd, 0xb58b, 0xa402, 0x9699, 0x8710, 0xf3af, 0xe226, 0xd0bd, 0xc134,
+        0x39c3, 0x284a, 0x1ad1, 0x0b58, 0x7fe7, 0x6e6e, 0x5cf5, 0x4d7c, 0xc60c,
+        0xd785, 0xe51e, 0xf497, 0x8028, 0x91a1, 0xa33a, 0xb2b3, 0x4a44, 0x5bcd,
+        0x6956, 0x78df, 0x0c60, 0x1de9, 0x2f72, 0x3efb, 0xd68d, 0xc704, 0xf59f,
+        0xe416, 0x90a9, 0x8120, 0xb3bb, 0xa232, 0x5ac5, 0x4b4c, 0x79d7, 0x685e,
+        0x1ce1, 0x0d68, 0x3ff3, 0x2e7a, 0xe70e, 0xf687, 0xc41c, 0xd595, 0xa12a,
+        0xb0a3, 0x8238, 0x93b1, 0x6b46, 0x7acf, 0x4854, 0x59dd, 0x2d62, 0x3ceb,
+        0x0e70, 0x1ff9, 0xf78f, 0xe606, 0xd49d, 0xc514, 0xb1ab, 0xa022, 0x92b9,
+        0x8330, 0x7bc7, 0x6a4e, 0x58d5, 0x495c, 0x3de3, 0x2c6a, 0x1ef1, 0x0f78 };
+
     static constexpr uint16_t Fcs16InitValue = 0xffff;
     static constexpr uint16_t Fcs16GoodValue = 0xf0b8;
     static constexpr uint8_t FlagSequence = 0x7e;
     static constexpr uint8_t ControlEscape = 0x7d;
+    // Selective reject with 3-bit sequence numbers allows at most half of the sequence numbers in flight
+    static constexpr uint8_t MaxWindowSize = 4;
+    // Encoded at compile time (defined below the class as the encoding needs the complete class)
+    static const SupervisoryFrames BroadcastSupervisoryFrames;
 
     std::mutex writeMutex;
+    std::condition_variable writeCondition;
+    std::mutex transmitMutex;
+    std::condition_variable transmitCondition;
     TransportRead transportRead;
     TransportWrite transportWrite;
     Buffer<uint8_t> readBuffer;
     Container writeBuffer;
+    Container compressionWorkspace {};
+    Container compressionWriteBuffer {};
+    Container compressionReadBuffer {};
+    FrameTrace* frameTrace { nullptr };
+    std::array<CachedSupervisoryFrame, std::tuple_size_v<SupervisoryFrames>> supervisoryFrameCache {};
     Frame readFrame;
     uint16_t writeTimeout;
     uint8_t writeRetries;
-    uint8_t readSequenceNumber { 0 };
+    uint8_t windowSize;
+    // The first data frame is sent with sequence number 1
+    std::atomic<uint8_t> readSequenceNumber { 1 };
     uint8_t writeSequenceNumber { 0 };
+    uint8_t writeReserved { 0 };
+    uint8_t receiveMask { 0 };
+    uint8_t rejectMask { 0 };
+    TransportAddress receiveNotReadyAddress { AddressBroadcast };
     std::atomic<int> writeResult { -1 };
+    std::array<WriteSlot, 8> writeSlots {};
+    std::array<std::atomic<int>, 8> writeStates {};
+    std::array<uint8_t, 8> writeRetransmissions {};
+    std::array<uint32_t, PriorityClasses> writeTickets {};
+    std::array<uint32_t, PriorityClasses> writeServing {};
+    std::array<uint16_t, PriorityClasses> transmitWaiting {};
+    bool transmitting { false };
+    bool congestionControl { false };
+    std::atomic<uint8_t> writeOutstanding { 0 };
+    std::atomic<bool> receiveBusy { false };
+    std::atomic<bool> receiveNotReadySent { false };
     std::atomic<bool> stopped { false };
 };
 
+inline constexpr Hdlcpp::SupervisoryFrames Hdlcpp::BroadcastSupervisoryFrames { Hdlcpp::encodeSupervisoryFrames(AddressBroadcast) };
+
 } // namespace Hdlcpp
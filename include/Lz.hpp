@@ -0,0 +1,236 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2020 Bang & Olufsen a/s
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+namespace Hdlcpp {
+
+//! @brief A lightweight LZ77 codec using the LZ4 block format without allocating from the heap
+//! @details A compressed block is a sequence of tokens. Each token holds a literal length and a match
+//!          length (minus 4) as nibbles, where 15 is extended by additional bytes. The literals follow
+//!          the token and then the 16-bit little endian match offset. The last token has no match.
+//!          As required by the LZ4 format, the last match starts at least 12 bytes before the end of the
+//!          block and the last 5 bytes are literals, so other LZ4 decoders accept the compressed blocks.
+class Lz {
+public:
+    //! @brief Compresses the source into the destination
+    //! @param source The data to compress (less than 64 KiB)
+    //! @param destination Buffer for the compressed data
+    //! @param workspace Working memory for the match finder hash table (2 bytes per entry)
+    //! @return The compressed size if positive or an error code from <cerrno> (-ENOSPC if it does not fit)
+    static int compress(std::span<const uint8_t> source, std::span<uint8_t> destination, std::span<uint8_t> workspace)
+    {
+        size_t sourceIndex { 0 }, anchor { 0 }, destinationIndex { 0 };
+
+        if (!source.data() || source.empty() || (source.size() > MaxSourceSize) || (workspace.size() < 2))
+            return -EINVAL;
+
+        // A hash table larger than the source does not find more matches but takes longer to clear
+        const size_t tableEntries { std::min(std::bit_floor(workspace.size() / 2), std::bit_ceil(source.size())) };
+        const int tableShift { 32 - std::countr_zero(tableEntries) };
+        std::fill_n(workspace.begin(), tableEntries * 2, 0);
+
+        while ((sourceIndex + MatchStartLimit) <= source.size()) {
+            const uint32_t sequence { read32(source, sourceIndex) };
+            const size_t hash { (tableShift < 32) ? ((sequence * 2654435761u) >> tableShift) : 0 };
+            // Positions are stored off by one so zero marks an empty entry
+            const size_t candidate { read16(workspace, hash * 2) };
+            write16(workspace, hash * 2, sourceIndex + 1);
+
+            if ((candidate == 0) || (read32(source, candidate - 1) != sequence)) {
+                sourceIndex++;
+                continue;
+            }
+
+            const size_t match { candidate - 1 };
+            size_t length { MinMatch };
+            while (((sourceIndex + length) < (source.size() - LastLiterals)) && (source[match + length] == source[sourceIndex + length]))
+                length++;
+
+            if (!writeSequence(destination, destinationIndex, source.subspan(anchor, sourceIndex - anchor), sourceIndex - match, length))
+                return -ENOSPC;
+
+            sourceIndex += length;
+            anchor = sourceIndex;
+        }
+
+        if (!writeSequence(destination, destinationIndex, source.subspan(anchor), 0, 0))
+            return -ENOSPC;
+
+        return destinationIndex;
+    }
+
+    //! @brief Decompresses the source into the destination
+    //! @param source The compressed data
+    //! @param destination Buffer for the decompressed data
+    //! @return The decompressed size if positive or an error code from <cerrno>
+    static int decompress(std::span<const uint8_t> source, std::span<uint8_t> destination)
+    {
+        size_t sourceIndex { 0 }, destinationIndex { 0 };
+
+        if (!source.data() || source.empty() || !destination.data())
+            return -EINVAL;
+
+        while (sourceIndex < source.size()) {
+            const uint8_t token { source[sourceIndex++] };
+            size_t length { static_cast<size_t>(token >> 4) };
+
+            if (!readLength(source, sourceIndex, length))
+                return -EIO;
+
+            if ((sourceIndex + length) > source.size())
+                return -EIO;
+            if ((destinationIndex + length) > destination.size())
+                return -EMSGSIZE;
+
+            std::copy_n(source.begin() + sourceIndex, length, destination.begin() + destinationIndex);
+            sourceIndex += length;
+            destinationIndex += length;
+
+            // The last sequence has no match
+            if (sourceIndex == source.size())
+                break;
+
+            if ((sourceIndex + 2) > source.size())
+                return -EIO;
+
+            const size_t offset { source[sourceIndex] | (static_cast<size_t>(source[sourceIndex + 1]) << 8) };
+            sourceIndex += 2;
+            if ((offset == 0) || (offset > destinationIndex))
+                return -EIO;
+
+            length = token & 0x0f;
+            if (!readLength(source, sourceIndex, length))
+                return -EIO;
+
+            length += MinMatch;
+            if ((destinationIndex + length) > destination.size())
+                return -EMSGSIZE;
+
+            // Copy byte by byte as the match may overlap the output
+            for (size_t i = 0; i < length; i++, destinationIndex++)
+                destination[destinationIndex] = destination[destinationIndex - offset];
+        }
+
+        return destinationIndex;
+    }
+
+    //! @brief The recommended workspace size (4096 hash table entries)
+    static constexpr size_t WorkspaceSize { 8192 };
+
+protected:
+    static bool writeSequence(std::span<uint8_t> destination, size_t& destinationIndex, std::span<const uint8_t> literals, size_t offset, size_t length)
+    {
+        const size_t matchLength { (length > 0) ? (length - MinMatch) : 0 };
+        const uint8_t token = (std::min<size_t>(literals.size(), 15) << 4) | std::min<size_t>(matchLength, 15);
+
+        if (!writeByte(destination, destinationIndex, token) || !writeLength(destination, destinationIndex, literals.size()))
+            return false;
+
+        if ((destinationIndex + literals.size()) > destination.size())
+            return false;
+
+        std::copy(literals.begin(), literals.end(), destination.begin() + destinationIndex);
+        destinationIndex += literals.size();
+
+        if (length == 0)
+            return true;
+
+        if (!writeByte(destination, destinationIndex, offset & 0xff) || !writeByte(destination, destinationIndex, (offset >> 8) & 0xff))
+            return false;
+
+        return writeLength(destination, destinationIndex, matchLength);
+    }
+
+    static bool writeLength(std::span<uint8_t> destination, size_t& destinationIndex, size_t length)
+    {
+        if (length < 15)
+            return true;
+
+        for (length -= 15; length >= 255; length -= 255) {
+            if (!writeByte(destination, destinationIndex, 255))
+                return false;
+        }
+
+        return writeByte(destination, destinationIndex, length);
+    }
+
+    static bool writeByte(std::span<uint8_t> destination, size_t& destinationIndex, uint8_t value)
+    {
+        if (destinationIndex >= destination.size())
+            return false;
+
+        destination[destinationIndex++] = value;
+        return true;
+    }
+
+    static bool readLength(std::span<const uint8_t> source, size_t& sourceIndex, size_t& length)
+    {
+        if (length < 15)
+            return true;
+
+        uint8_t value;
+        do {
+            if (sourceIndex >= source.size())
+                return false;
+
+            value = source[sourceIndex++];
+            length += value;
+        } while (value == 255);
+
+        return true;
+    }
+
+    static uint32_t read32(std::span<const uint8_t> source, size_t index)
+    {
+        uint32_t value;
+        std::memcpy(&value, source.data() + index, sizeof(value));
+        return value;
+    }
+
+    static size_t read16(std::span<const uint8_t> source, size_t index)
+    {
+        return source[index] | (static_cast<size_t>(source[index + 1]) << 8);
+    }
+
+    static void write16(std::span<uint8_t> destination, size_t index, size_t value)
+    {
+        destination[index] = value & 0xff;
+        destination[index + 1] = (value >> 8) & 0xff;
+    }
+
+    static constexpr size_t MinMatch { 4 };
+    // The end of block restrictions of the LZ4 format
+    static constexpr size_t MatchStartLimit { 12 };
+    static constexpr size_t LastLiterals { 5 };
+    // Positions are stored in 16 bits which also limits the match offset
+    static constexpr size_t MaxSourceSize { 0xfffe };
+};
+
+} // namespace Hdlcpp
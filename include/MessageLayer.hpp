@@ -0,0 +1,284 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2020 Bang & Olufsen a/s
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "Hdlcpp.hpp"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <mutex>
+
+namespace Hdlcpp {
+
+//! @brief Receives the fragments of a message as they arrive
+//! @param offset The offset of the fragment within the message
+//! @param data The fragment data
+//! @return Zero on success or a negative error code from <cerrno> to abort the message
+using MessageSink = std::function<int(size_t offset, ConstContainer data)>;
+
+//! @brief Fragments messages larger than a frame into pipelined frames and reassembles them at the receiver
+//! @details Each fragment is prefixed with a header holding flags, a message id and the 32-bit
+//!          offset of the fragment. With a windowSize above 1 the fragments may arrive out of order.
+//!          The flags hold a session picked by the sender when constructed, so the message ids of a
+//!          restarted sender are not mistaken for repeated fragments (unless it picks the same 7-bit
+//!          session). A single message is reassembled at a time, so a fragment of another message
+//!          (e.g. from another address) abandons the message in progress.
+class MessageLayer {
+public:
+    //! @brief Constructs the MessageLayer instance
+    //! @param hdlcpp The Hdlcpp instance used for the fragments (the MessageLayer must be its only writer)
+    //! @param readBuffer Buffer for receiving a single fragment (header and frame payload)
+    //! @param writeBuffer Buffer split into a fragment slot for each frame in the Hdlcpp window of the priority class
+    MessageLayer(Hdlcpp& hdlcpp, Container readBuffer, Container writeBuffer)
+        : hdlcpp(hdlcpp)
+        , readBuffer(readBuffer)
+        , writeBuffer(writeBuffer)
+        , writeSession(std::chrono::steady_clock::now().time_since_epoch().count() % (FragmentSessionMask + 1))
+    {
+    }
+
+    //! @brief Destructs the MessageLayer instance
+    virtual ~MessageLayer() = default;
+
+    //! @brief Reads a message reassembled from its fragments (blocks if TransportRead is blocking)
+    //! @param buffer Buffer for storing the complete message
+    //! @return The message size if positive or an error code from <cerrno>
+    virtual ReadResponse read(Container buffer)
+    {
+        if (!buffer.data() || buffer.empty())
+            return { -EINVAL, AddressBroadcast };
+
+        return readFragments([buffer](size_t offset, ConstContainer data) {
+            if ((offset + data.size()) > buffer.size())
+                return -EMSGSIZE;
+
+            std::copy(data.begin(), data.end(), buffer.begin() + offset);
+            return 0;
+        });
+    }
+
+    //! @brief Reads a message by streaming its fragments to a sink (blocks if TransportRead is blocking)
+    //! @param sink The sink receiving the fragments as they arrive
+    //! @return The message size if positive or an error code from <cerrno>
+    virtual ReadResponse read(const MessageSink& sink)
+    {
+        if (!sink)
+            return { -EINVAL, AddressBroadcast };
+
+        return readFragments(sink);
+    }
+
+    //! @brief Writes a message as pipelined fragments (thread safe)
+    //! @param address Address of the receiver
+    //! @param buffer Buffer storing the message to be sent
+    //! @param priority The priority class of the fragments
+    //! @return The number of bytes sent if positive or an error code from <cerrno>
+    virtual int write(TransportAddress address, ConstContainer buffer, Priority priority = PriorityNormal)
+    {
+        int result { 0 };
+        uint8_t slot { 0 };
+        const uint8_t fragments { hdlcpp.window(priority) };
+        const size_t slotSize { writeBuffer.size() / fragments };
+        std::array<int, MaxWindowSlots> sequenceNumbers;
+
+        if (!buffer.data() || buffer.empty() || (slotSize <= HeaderSize))
+            return -EINVAL;
+
+        if (buffer.size() > std::numeric_limits<int>::max())
+            return -EMSGSIZE;
+
+        std::lock_guard<std::mutex> writeLock(writeMutex);
+        const size_t fragmentSize { slotSize - HeaderSize };
+        const uint8_t messageId { ++writeMessageId };
+        sequenceNumbers.fill(-1);
+
+        for (size_t offset = 0; offset < buffer.size(); offset += fragmentSize) {
+            // Reuse the slot once the fragment previously sent from it has been acknowledged
+            if (sequenceNumbers[slot] >= 0) {
+                result = hdlcpp.writeWait(sequenceNumbers[slot]);
+                sequenceNumbers[slot] = -1;
+                if (result < 0)
+                    break;
+            }
+
+            const auto data { buffer.subspan(offset, std::min(fragmentSize, buffer.size() - offset)) };
+            const auto fragment { writeBuffer.subspan(slot * slotSize, HeaderSize + data.size()) };
+
+            fragment[0] = (writeSession << FragmentSessionShift) | (((offset + data.size()) == buffer.size()) ? FragmentLast : 0);
+            fragment[1] = messageId;
+            for (uint8_t i = 0; i < sizeof(uint32_t); i++)
+                fragment[2 + i] = (offset >> (8 * i)) & 0xff;
+            std::copy(data.begin(), data.end(), fragment.begin() + HeaderSize);
+
+            if ((result = hdlcpp.writeAsync(address, fragment, priority)) < 0)
+                break;
+
+            sequenceNumbers[slot] = result;
+            if (++slot >= fragments)
+                slot = 0;
+        }
+
+        // Wait for the fragments still in flight in the order they were sent
+        for (uint8_t i = 0; i < fragments; i++) {
+            int& sequenceNumber = sequenceNumbers[(slot + i) % fragments];
+            if (sequenceNumber >= 0) {
+                const int waitResult { hdlcpp.writeWait(sequenceNumber) };
+                if ((result >= 0) && (waitResult < 0))
+                    result = waitResult;
+                sequenceNumber = -1;
+            }
+        }
+
+        return (result < 0) ? result : static_cast<int>(buffer.size());
+    }
+
+protected:
+    enum Fragment {
+        FragmentLast = 0x01,
+        FragmentSessionShift = 1,
+        FragmentSessionMask = 0x7f,
+    };
+
+    enum ReadState {
+        ReadActive,
+        ReadComplete,
+        ReadAborted,
+    };
+
+    //! @brief A fragment received ahead of a missing fragment
+    struct FragmentRange {
+        size_t offset;
+        size_t end;
+    };
+
+    template <typename Sink>
+    ReadResponse readFragments(Sink&& sink)
+    {
+        while (true) {
+            const auto response { hdlcpp.read(readBuffer) };
+            if (response.size <= 0)
+                return response;
+
+            if (response.size <= static_cast<int>(HeaderSize))
+                return { -EPROTO, response.address };
+
+            const auto fragment { readBuffer.first(response.size) };
+            const auto data { fragment.subspan(HeaderSize) };
+            size_t offset { 0 };
+            for (uint8_t i = 0; i < sizeof(uint32_t); i++)
+                offset |= static_cast<size_t>(fragment[2 + i]) << (8 * i);
+
+            // A message is identified by its address, the session of the sender and its message id
+            const int32_t messageKey { (response.address << 16) | (((fragment[0] >> FragmentSessionShift) & FragmentSessionMask) << 8) | fragment[1] };
+            if (messageKey != readMessageKey) {
+                readMessageKey = messageKey;
+                readState = ReadActive;
+                readContiguous = 0;
+                readSize = 0;
+                readPendingCount = 0;
+            }
+
+            // Skip fragments of a completed or aborted message and repeated fragments from retransmissions
+            if ((readState != ReadActive) || fragmentReceived(offset))
+                continue;
+
+            // More fragments ahead of a missing fragment than can be in flight
+            if ((offset != readContiguous) && (readPendingCount == readPending.size())) {
+                readState = ReadAborted;
+                return { -EPROTO, response.address };
+            }
+
+            int result;
+            if ((result = sink(offset, data)) < 0) {
+                readState = ReadAborted;
+                return { result, response.address };
+            }
+
+            if (fragment[0] & FragmentLast)
+                readSize = offset + data.size();
+
+            if (offset == readContiguous) {
+                readContiguous += data.size();
+                mergePendingFragments();
+            } else {
+                readPending[readPendingCount++] = { offset, offset + data.size() };
+            }
+
+            if ((readSize > 0) && (readContiguous >= readSize)) {
+                readState = ReadComplete;
+                return { static_cast<int>(readSize), response.address };
+            }
+        }
+    }
+
+    bool fragmentReceived(size_t offset) const
+    {
+        if (offset < readContiguous)
+            return true;
+
+        for (uint8_t i = 0; i < readPendingCount; i++) {
+            if (readPending[i].offset == offset)
+                return true;
+        }
+
+        return false;
+    }
+
+    void mergePendingFragments()
+    {
+        // Extend the received part of the message with the fragments received ahead of it
+        for (uint8_t i = 0; i < readPendingCount;) {
+            if (readPending[i].offset == readContiguous) {
+                readContiguous = readPending[i].end;
+                readPending[i] = readPending[--readPendingCount];
+                i = 0;
+            } else {
+                i++;
+            }
+        }
+    }
+
+    // Flags; Message id; 32-bit offset
+    static constexpr size_t HeaderSize = 6;
+    // The window is limited by the 3-bit sequence numbers
+    static constexpr uint8_t MaxWindowSlots = 8;
+
+    std::mutex writeMutex;
+    Hdlcpp& hdlcpp;
+    Container readBuffer;
+    Container writeBuffer;
+    uint8_t writeMessageId { 0 };
+    uint8_t writeSession;
+    int32_t readMessageKey { -1 };
+    ReadState readState { ReadComplete };
+    // The size of the message received without gaps from its start
+    size_t readContiguous { 0 };
+    size_t readSize { 0 };
+    std::array<FragmentRange, MaxWindowSlots> readPending {};
+    uint8_t readPendingCount { 0 };
+};
+
+} // namespace Hdlcpp
@@ -0,0 +1,300 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2020 Bang & Olufsen a/s
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "Hdlcpp.hpp"
+#include <array>
+#include <cerrno>
+
+namespace Hdlcpp {
+
+//! @brief Precomputed tables for zero-bit insertion and deletion a byte at a time
+struct BitStuffing {
+    //! @brief Bits to output, the number of bits and the number of trailing 1 bits for a byte in a given state
+    struct Entry {
+        uint16_t bits;
+        uint8_t size;
+        uint8_t ones;
+    };
+
+    //! @brief Marks a byte holding six 1 bits (a flag sequence or abort) which is decoded a bit at a time
+    static constexpr uint8_t Event = 0xff;
+
+    //! @brief Builds the table for inserting a 0 bit after five 1 bits, by 1 bits pending and byte to send
+    static constexpr std::array<std::array<Entry, 256>, 5> makeStuffTable()
+    {
+        std::array<std::array<Entry, 256>, 5> table {};
+
+        for (uint8_t state = 0; state < table.size(); state++) {
+            for (uint16_t value = 0; value < 256; value++) {
+                Entry entry { 0, 0, state };
+                for (uint8_t i = 0; i < 8; i++) {
+                    if ((value >> i) & 0x1) {
+                        entry.bits |= 1 << entry.size++;
+                        if (++entry.ones == 5) {
+                            // Insert a 0 bit
+                            entry.size++;
+                            entry.ones = 0;
+                        }
+                    } else {
+                        entry.size++;
+                        entry.ones = 0;
+                    }
+                }
+                table[state][value] = entry;
+            }
+        }
+
+        return table;
+    }
+
+    //! @brief Builds the table for deleting the inserted 0 bits, by 1 bits pending and byte received
+    static constexpr std::array<std::array<Entry, 256>, 6> makeDestuffTable()
+    {
+        std::array<std::array<Entry, 256>, 6> table {};
+
+        // The state is the number of 1 bits received but not output until it is known they are data
+        for (uint8_t state = 0; state < table.size(); state++) {
+            for (uint16_t value = 0; value < 256; value++) {
+                Entry entry { 0, 0, state };
+                for (uint8_t i = 0; (i < 8) && (entry.ones != Event); i++) {
+                    if ((value >> i) & 0x1) {
+                        if (++entry.ones > 5)
+                            entry.ones = Event;
+                    } else {
+                        // Output the pending 1 bits and the 0 bit unless it was inserted after five 1 bits
+                        entry.bits |= ((1 << entry.ones) - 1) << entry.size;
+                        entry.size += (entry.ones == 5) ? entry.ones : (entry.ones + 1);
+                        entry.ones = 0;
+                    }
+                }
+                table[state][value] = entry;
+            }
+        }
+
+        return table;
+    }
+};
+
+//! @brief Hdlcpp using synchronous HDLC framing (zero-bit insertion) instead of asynchronous byte stuffing
+//! @details After five consecutive 1 bits a 0 bit is inserted, so the flag sequence (six 1 bits) can
+//!          not occur within a frame. Bits are sent least significant bit first and a frame is padded
+//!          with 1 bits (idle) to the next byte boundary. The FCS and ARQ logic is shared with Hdlcpp.
+//!          Buffers should be sized using Calculate::WithSyncOverhead.
+class SyncHdlcpp : public Hdlcpp {
+public:
+    using Hdlcpp::Hdlcpp;
+
+protected:
+    int encode(TransportAddress address, Frame& frame, uint8_t& sequenceNumber, ConstContainer source, Hdlcpp::span<uint8_t> destination) override
+    {
+        uint32_t bits { 0 };
+        uint8_t size { 0 }, ones { 0 };
+        uint16_t fcs16Value { Fcs16InitValue };
+
+        auto flush = [&]() {
+            for (; size >= 8; size -= 8, bits >>= 8) {
+                if (!destination.push_back(bits & 0xff))
+                    return false;
+            }
+            return true;
+        };
+
+        auto stuff = [&](uint8_t value) {
+            const BitStuffing::Entry& entry { StuffTable[ones][value] };
+            bits |= static_cast<uint32_t>(entry.bits) << size;
+            size += entry.size;
+            ones = entry.ones;
+            return flush();
+        };
+
+        if (!destination.push_back(FlagSequence))
+            return -EINVAL;
+
+        fcs16Value = fcs16(fcs16Value, address);
+        if (!stuff(address))
+            return -EINVAL;
+
+        const uint8_t value { encodeControlByte(frame, sequenceNumber) };
+        fcs16Value = fcs16(fcs16Value, value);
+        if (!stuff(value))
+            return -EINVAL;
+
+        if ((frame == FrameData) || (frame == FrameCompressedData)) {
+            if (!source.data() || source.empty())
+                return -EINVAL;
+
+            for (const auto& byte : source) {
+                fcs16Value = fcs16(fcs16Value, byte);
+                if (!stuff(byte))
+                    return -EINVAL;
+            }
+        }
+
+        // Invert the FCS value accordingly to the specification
+        fcs16Value ^= 0xFFFF;
+
+        if (!stuff(fcs16Value & 0xFF) || !stuff((fcs16Value >> 8) & 0xFF))
+            return -EINVAL;
+
+        // The closing flag sequence is not stuffed and is followed by idle 1 bits up to the byte boundary
+        bits |= static_cast<uint32_t>(FlagSequence) << size;
+        size += 8;
+        bits |= ((1u << ((8 - (size % 8)) % 8)) - 1) << size;
+        size = (size + 7) & ~7;
+
+        if (!flush())
+            return -EINVAL;
+
+        return destination.size();
+    }
+
+    int decode(TransportAddress& address, Frame& frame, uint8_t& sequenceNumber, const Container source, Container destination, uint16_t& discardBytes) const override
+    {
+        const size_t sourceBits { source.size() * 8 };
+        bool hunting { true };
+        uint8_t flag { 0 }, ones { 0 }, size { 0 };
+        uint32_t bits { 0 };
+        uint16_t fcs16Value { Fcs16InitValue };
+        int frameSize { 0 }, destinationIndex { 0 };
+
+        discardBytes = 0;
+        if (!destination.data() || destination.empty())
+            return -EINVAL;
+
+        auto receive = [&](uint32_t value, uint8_t valueSize) {
+            bits |= value << size;
+            for (size += valueSize; size >= 8; size -= 8, bits >>= 8) {
+                const uint8_t byte = bits & 0xff;
+                fcs16Value = fcs16(fcs16Value, byte);
+
+                // Address; Control; Data ..
+                if (frameSize == 0) {
+                    address = byte;
+                } else if (frameSize == 1) {
+                    decodeControlByte(byte, frame, sequenceNumber);
+                } else {
+                    // Keep counting to detect data not fitting the destination (the trailing FCS is not needed)
+                    if (destinationIndex < static_cast<int>(destination.size()))
+                        destination[destinationIndex] = byte;
+                    destinationIndex++;
+                }
+
+                frameSize++;
+            }
+        };
+
+        auto start = [&]() {
+            hunting = false;
+            ones = size = 0;
+            bits = 0;
+            fcs16Value = Fcs16InitValue;
+            frameSize = destinationIndex = 0;
+        };
+
+        for (size_t i = 0; i < sourceBits;) {
+            if (hunting) {
+                // Find the opening flag sequence at any bit position
+                flag = (flag >> 1) | (bitAt(source, i++) << 7);
+                if (flag == FlagSequence)
+                    start();
+
+                continue;
+            }
+
+            // Destuff a whole byte at a time unless it holds a flag sequence or abort
+            if ((ones < DestuffTable.size()) && ((i + 8) <= sourceBits)) {
+                const BitStuffing::Entry& entry { DestuffTable[ones][byteAt(source, i)] };
+                if (entry.ones != BitStuffing::Event) {
+                    receive(entry.bits, entry.size);
+                    ones = entry.ones;
+                    i += 8;
+                    continue;
+                }
+            }
+
+            if (bitAt(source, i++)) {
+                // Seven or more 1 bits abort the frame (or the link is idle)
+                if (++ones > 6) {
+                    hunting = true;
+                    flag = 0xff;
+                }
+                continue;
+            }
+
+            if (ones <= 5) {
+                // Output the pending 1 bits and the 0 bit unless it was inserted after five 1 bits
+                receive((1u << ones) - 1, (ones == 5) ? ones : (ones + 1));
+                ones = 0;
+                continue;
+            }
+
+            // A flag sequence where the leading 0 bit has been received as data
+            if (frameSize < 4) {
+                // Just start again to silently discard it (accordingly to HDLC)
+                start();
+                continue;
+            }
+
+            // The closing flag sequence is kept as it may be the opening flag sequence of the next frame
+            discardBytes = (i - 8) / 8;
+
+            // A frame has a valid FCS value and ends at a byte boundary
+            if ((size == 1) && (fcs16Value == Fcs16GoodValue)) {
+                if ((destinationIndex - 2) > static_cast<int>(destination.size()))
+                    return -EMSGSIZE;
+
+                return destinationIndex - 2;
+            }
+
+            return -EIO;
+        }
+
+        return -ENOMSG;
+    }
+
+    std::span<const value_type> supervisoryFrame(TransportAddress, Frame, uint8_t) override
+    {
+        // The supervisory frames are encoded in advance with byte stuffing so encode them with zero-bit insertion
+        return {};
+    }
+
+    static uint8_t bitAt(const Container source, size_t index)
+    {
+        return (source[index / 8] >> (index % 8)) & 0x1;
+    }
+
+    static uint8_t byteAt(const Container source, size_t index)
+    {
+        const uint8_t shift = index % 8;
+        if (shift == 0)
+            return source[index / 8];
+
+        return (source[index / 8] >> shift) | (source[(index / 8) + 1] << (8 - shift));
+    }
+
+    static constexpr std::array<std::array<BitStuffing::Entry, 256>, 5> StuffTable { BitStuffing::makeStuffTable() };
+    static constexpr std::array<std::array<BitStuffing::Entry, 256>, 6> DestuffTable { BitStuffing::makeDestuffTable() };
+};
+
+} // namespace Hdlcpp
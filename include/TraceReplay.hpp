@@ -0,0 +1,121 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2020 Bang & Olufsen a/s
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "FrameTrace.hpp"
+#include "Hdlcpp.hpp"
+#include <algorithm>
+#include <cerrno>
+
+namespace Hdlcpp {
+
+//! @brief Replays the received frames of a trace as the transport of an Hdlcpp instance
+//! @details Used as the TransportRead of the replaying instance, so Hdlcpp::read processes the same
+//!          sequence of frames as when the trace was recorded. The payloads are not recorded so the
+//!          frames are replayed with zeroed payloads of the recorded size, and frames received with
+//!          an FCS error are replayed with a corrupted FCS. The frames are replayed as fast as they
+//!          are read, which makes a replay deterministic.
+class TraceReplay : protected Hdlcpp {
+public:
+    //! @brief Constructs the TraceReplay instance
+    //! @param events The events of the trace (see FrameTrace::dump)
+    //! @param payloadBuffer Buffer for the payload of a frame (the size of the largest payload)
+    //! @param frameBuffer Buffer for encoding a frame (see Calculate<Capacity>::WithOverhead)
+    TraceReplay(std::span<const FrameTrace::Event> events, Container payloadBuffer, Container frameBuffer)
+        : Hdlcpp([](Container) { return -EIO; }, [](ConstContainer) { return -EIO; }, {}, frameBuffer)
+        , events(events)
+        , payloadBuffer(payloadBuffer)
+    {
+        std::fill(payloadBuffer.begin(), payloadBuffer.end(), 0);
+    }
+
+    //! @brief Reads the next bytes of the received frames (to be called as the TransportRead)
+    //! @param buffer Buffer for the bytes
+    //! @return The number of bytes read if positive, zero at the end of the trace or an error code from <cerrno>
+    int readFrames(Container buffer)
+    {
+        int result;
+
+        while (frameOffset == frameSize) {
+            if (nextEvent == events.size())
+                return 0;
+
+            const FrameTrace::Event& event { events[nextEvent++] };
+            if (event.direction != FrameTrace::DirectionReceive)
+                continue;
+
+            if ((result = encodeEvent(event)) < 0)
+                return result;
+
+            frameOffset = 0;
+            frameSize = result;
+        }
+
+        const size_t size { std::min(buffer.size(), frameSize - frameOffset) };
+        std::copy_n(writeBuffer.begin() + frameOffset, size, buffer.begin());
+        frameOffset += size;
+
+        return size;
+    }
+
+    //! @brief Returns the number of events replayed (including the events not replayed as they were transmitted)
+    size_t replayed() const
+    {
+        return nextEvent;
+    }
+
+protected:
+    int encodeEvent(const FrameTrace::Event& event)
+    {
+        int result;
+        Frame frame;
+        uint8_t sequenceNumber;
+
+        decodeControlByte(event.control, frame, sequenceNumber);
+
+        // A data frame is never empty (its size is not known if it was not received correctly)
+        const bool data { (frame == FrameData) || (frame == FrameCompressedData) };
+        const size_t size { data ? std::max<size_t>(event.length, 1) : 0 };
+        if (size > payloadBuffer.size())
+            return -EMSGSIZE;
+
+        if ((result = encode(event.address, frame, sequenceNumber, payloadBuffer.first(size), { writeBuffer })) < 0)
+            return result;
+
+        if (event.result == -EIO) {
+            // Corrupt the last FCS byte without turning it into a flag sequence or control escape
+            uint8_t& value { writeBuffer[result - 2] };
+            value ^= (((value ^ 0x01) == FlagSequence) || ((value ^ 0x01) == ControlEscape)) ? 0x10 : 0x01;
+        }
+
+        return result;
+    }
+
+    std::span<const FrameTrace::Event> events;
+    Container payloadBuffer;
+    size_t nextEvent { 0 };
+    size_t frameOffset { 0 };
+    size_t frameSize { 0 };
+};
+
+} // namespace Hdlcpp
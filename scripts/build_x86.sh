@@ -2,7 +2,7 @@
 set -e
 
 mkdir -p .build-x86; pushd .build-x86
-cmake --no-warn-unused-cli -DBUILD_EXTERNAL=1 -DCMAKE_TOOLCHAIN_FILE=cmake/gcc.cmake ..;
+cmake --no-warn-unused-cli -DBUILD_EXTERNAL=1 -DBUILD_HDLCPP_BENCHMARK=1 -DBUILD_HDLCPP_TOOLS=1 -DCMAKE_TOOLCHAIN_FILE=cmake/gcc.cmake ..;
 make -j "$(nproc)"
 sudo make -j "$(nproc)" install
 
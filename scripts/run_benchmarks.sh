@@ -0,0 +1,9 @@
+#!/bin/bash
+set -e
+
+pushd .build-x86/benchmark
+for benchmark in benchmark-*; do
+  echo "$benchmark"
+  "./$benchmark" "$@"
+done
+popd
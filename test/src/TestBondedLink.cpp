@@ -0,0 +1,305 @@
+#include "turtle/catch.hpp"
+#include <catch.hpp>
+
+#define protected public
+#include "BondedLink.hpp"
+#include <deque>
+#include <thread>
+
+class BondedLinkFixture {
+public:
+    static constexpr uint16_t bufferSize = 64;
+    static constexpr uint8_t reorderWindow = 4;
+    static constexpr size_t links = 2;
+
+    BondedLinkFixture()
+    {
+        for (size_t i = 0; i < links; i++) {
+            // A writeTimeout of 0 makes a link write return once the frame is sent instead of waiting for the
+            // ack, and the receivers are polled through receive(), so the tests drive both ends of the bond
+            senders[i] = std::make_shared<Hdlcpp::Hdlcpp>(
+                [](Hdlcpp::Container) { return 0; },
+                [this, i](Hdlcpp::ConstContainer buffer) { return transportWrite(i, buffer); },
+                sender_readBuffers[i], sender_writeBuffers[i], 0);
+            receivers[i] = std::make_shared<Hdlcpp::Hdlcpp>(
+                [this, i](Hdlcpp::Container buffer) { return transportRead(i, buffer); },
+                [](Hdlcpp::ConstContainer buffer) { return static_cast<int>(buffer.size()); },
+                receiver_readBuffers[i], receiver_writeBuffers[i], 0);
+            receivers[i]->stopped = true;
+        }
+
+        sender = std::make_shared<Hdlcpp::BondedLink<links>>(
+            std::array<std::reference_wrapper<Hdlcpp::Hdlcpp>, links> { *senders[0], *senders[1] },
+            sender_readBuffer, sender_writeBuffer, reorderWindow);
+        receiver = std::make_shared<Hdlcpp::BondedLink<links>>(
+            std::array<std::reference_wrapper<Hdlcpp::Hdlcpp>, links> { *receivers[0], *receivers[1] },
+            receiver_readBuffer, receiver_writeBuffer, reorderWindow, 1);
+    }
+
+    // Sends a frame with the given bond sequence number directly on a link
+    void send(size_t link, uint16_t sequenceNumber, uint8_t value)
+    {
+        const uint8_t frame[3] = { static_cast<uint8_t>(sequenceNumber & 0xff), static_cast<uint8_t>(sequenceNumber >> 8), value };
+        senders[link]->write(Hdlcpp::AddressBroadcast, frame);
+    }
+
+    int transportRead(size_t link, Hdlcpp::Container buffer)
+    {
+        size_t size = 0;
+        while ((size < buffer.size()) && !wires[link].empty()) {
+            buffer[size++] = wires[link].front();
+            wires[link].pop_front();
+        }
+
+        return size;
+    }
+
+    int transportWrite(size_t link, Hdlcpp::ConstContainer buffer)
+    {
+        if (failing[link])
+            return -EIO;
+
+        wires[link].insert(wires[link].end(), buffer.begin(), buffer.end());
+        return buffer.size();
+    }
+
+    std::array<std::shared_ptr<Hdlcpp::Hdlcpp>, links> senders;
+    std::array<std::shared_ptr<Hdlcpp::Hdlcpp>, links> receivers;
+    std::shared_ptr<Hdlcpp::BondedLink<links>> sender;
+    std::shared_ptr<Hdlcpp::BondedLink<links>> receiver;
+    std::array<Hdlcpp::StaticBuffer<Hdlcpp::Calculate<bufferSize>::WithOverhead>, links> sender_readBuffers {};
+    std::array<Hdlcpp::StaticBuffer<Hdlcpp::Calculate<bufferSize>::WithOverhead>, links> sender_writeBuffers {};
+    std::array<Hdlcpp::StaticBuffer<Hdlcpp::Calculate<bufferSize>::WithOverhead>, links> receiver_readBuffers {};
+    std::array<Hdlcpp::StaticBuffer<Hdlcpp::Calculate<bufferSize>::WithOverhead>, links> receiver_writeBuffers {};
+    Hdlcpp::StaticBuffer<bufferSize*(links + reorderWindow)> sender_readBuffer {};
+    Hdlcpp::StaticBuffer<bufferSize * reorderWindow> sender_writeBuffer {};
+    Hdlcpp::StaticBuffer<bufferSize*(links + reorderWindow)> receiver_readBuffer {};
+    Hdlcpp::StaticBuffer<bufferSize * reorderWindow> receiver_writeBuffer {};
+    std::array<std::deque<uint8_t>, links> wires;
+    std::array<bool, links> failing {};
+    uint8_t dataBuffer[bufferSize];
+};
+
+TEST_CASE_METHOD(BondedLinkFixture, "bonded link test", "[single-file]")
+{
+    SECTION("Test write/read with invalid input")
+    {
+        std::vector<uint8_t> data(bufferSize);
+        CHECK(sender->write(Hdlcpp::AddressBroadcast, { dataBuffer, 0 }) == -EINVAL);
+        CHECK(sender->write(Hdlcpp::AddressBroadcast, {}) == -EINVAL);
+        // The frame does not fit in a slot together with the header
+        CHECK(sender->write(Hdlcpp::AddressBroadcast, data) == -EMSGSIZE);
+        CHECK(receiver->receive(links).size == -EINVAL);
+        CHECK(receiver->read({}).size == -EINVAL);
+    }
+
+    SECTION("Test write/read of frames striped across the links")
+    {
+        const uint8_t data[3] = { 0x11, 0x22, 0x33 };
+
+        for (const auto& byte : data)
+            CHECK(sender->write(Hdlcpp::AddressBroadcast, { &byte, 1 }) == 1);
+
+        // Receive the links in reverse order
+        for (size_t i = links; i-- > 0;) {
+            while (receiver->receive(i).size > 0)
+                ;
+        }
+
+        for (const auto& byte : data) {
+            CHECK(receiver->read(dataBuffer).size == 1);
+            CHECK(dataBuffer[0] == byte);
+        }
+    }
+
+    SECTION("Test read of frames out of order")
+    {
+        send(1, 1, 0x22);
+        send(0, 0, 0x11);
+
+        CHECK(receiver->receive(1).size == 1);
+        CHECK(receiver->receive(0).size == 1);
+
+        CHECK(receiver->read(dataBuffer).size == 1);
+        CHECK(dataBuffer[0] == 0x11);
+        CHECK(receiver->read(dataBuffer).size == 1);
+        CHECK(dataBuffer[0] == 0x22);
+    }
+
+    SECTION("Test read of a frame received on both links")
+    {
+        send(0, 0, 0x11);
+        send(1, 0, 0x11);
+
+        CHECK(receiver->receive(0).size == 1);
+        CHECK(receiver->receive(1).size == 0);
+        CHECK(receiver->read(dataBuffer).size == 1);
+        CHECK(receiver->readBuffered == 0);
+    }
+
+    SECTION("Test read skips a lost frame")
+    {
+        send(1, 1, 0x22);
+        CHECK(receiver->receive(1).size == 1);
+
+        // The missing frame is skipped after the loss timeout
+        CHECK(receiver->read(dataBuffer).size == 1);
+        CHECK(dataBuffer[0] == 0x22);
+
+        // The lost frame arriving late is dropped
+        send(0, 0, 0x11);
+        CHECK(receiver->receive(0).size == 0);
+    }
+
+    SECTION("Test read waits for a late frame")
+    {
+        receiver->lossTimeout = 1000;
+        send(1, 1, 0x22);
+        CHECK(receiver->receive(1).size == 1);
+
+        // The frame arrives after read has started waiting but before the loss timeout
+        std::thread thread([this] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            send(0, 0, 0x11);
+            receiver->receive(0);
+        });
+
+        CHECK(receiver->read(dataBuffer).size == 1);
+        CHECK(dataBuffer[0] == 0x11);
+        thread.join();
+    }
+
+    SECTION("Test reorder window is rounded down to a power of two")
+    {
+        const std::array<std::reference_wrapper<Hdlcpp::Hdlcpp>, links> bonded { *receivers[0], *receivers[1] };
+
+        CHECK(Hdlcpp::BondedLink<links>(bonded, receiver_readBuffer, receiver_writeBuffer, 0).reorderWindow == 1);
+        CHECK(Hdlcpp::BondedLink<links>(bonded, receiver_readBuffer, receiver_writeBuffer, 3).reorderWindow == 2);
+        CHECK(Hdlcpp::BondedLink<links>(bonded, receiver_readBuffer, receiver_writeBuffer, 100).reorderWindow == 64);
+    }
+
+    SECTION("Test read of frames out of order across the sequence number wrap")
+    {
+        Hdlcpp::BondedLink<links> bond({ *receivers[0], *receivers[1] }, receiver_readBuffer, receiver_writeBuffer, 3, 1);
+        bond.readSequenceNumber = 0xffff;
+
+        // With a window of 3 the sequence numbers 65535 and 0 would both use the first slot
+        send(1, 0, 0x22);
+        send(0, 0xffff, 0x11);
+        CHECK(bond.receive(1).size == 1);
+        CHECK(bond.receive(0).size == 1);
+
+        CHECK(bond.read(dataBuffer).size == 1);
+        CHECK(dataBuffer[0] == 0x11);
+        CHECK(bond.read(dataBuffer).size == 1);
+        CHECK(dataBuffer[0] == 0x22);
+        CHECK(bond.readSequenceNumber == 1);
+    }
+
+    SECTION("Test write/read across the sequence number wrap")
+    {
+        Hdlcpp::BondedLink<links> bondSender({ *senders[0], *senders[1] }, sender_readBuffer, sender_writeBuffer, 3);
+        Hdlcpp::BondedLink<links> bondReceiver({ *receivers[0], *receivers[1] }, receiver_readBuffer, receiver_writeBuffer, 3, 1);
+        bondSender.writeSequenceNumber = bondSender.writeOldest = 0xfffe;
+        bondReceiver.readSequenceNumber = 0xfffe;
+
+        for (uint8_t i = 0; i < 4; i++) {
+            CHECK(bondSender.write(Hdlcpp::AddressBroadcast, { &i, 1 }) == 1);
+            for (size_t link = 0; link < links; link++) {
+                while (bondReceiver.receive(link).size > 0)
+                    ;
+            }
+
+            CHECK(bondReceiver.read(dataBuffer).size == 1);
+            CHECK(dataBuffer[0] == i);
+        }
+
+        CHECK(bondSender.writeSequenceNumber == 2);
+        CHECK(bondSender.writeOldest == 2);
+        CHECK(bondReceiver.readSequenceNumber == 2);
+    }
+
+    SECTION("Test read skips a frame lost on every link with a reorder window of 1")
+    {
+        const uint8_t data[2] = { 0x11, 0x22 };
+        Hdlcpp::BondedLink<links> bondSender({ *senders[0], *senders[1] }, sender_readBuffer, sender_writeBuffer, 1);
+        Hdlcpp::BondedLink<links> bondReceiver({ *receivers[0], *receivers[1] }, receiver_readBuffer, receiver_writeBuffer, 1, 1);
+
+        // The first frame fails on every link, which releases its place in the window at the sender
+        failing = { true, true };
+        CHECK(bondSender.write(Hdlcpp::AddressBroadcast, { &data[0], 1 }) < 0);
+        failing = { false, false };
+        CHECK(bondSender.write(Hdlcpp::AddressBroadcast, { &data[1], 1 }) == 1);
+
+        // The second frame waits in receive() for the window to move past the lost frame
+        std::thread thread([&] {
+            for (size_t link = 0; link < links; link++) {
+                while (bondReceiver.receive(link).size > 0)
+                    ;
+            }
+        });
+
+        CHECK(bondReceiver.read(dataBuffer).size == 1);
+        CHECK(dataBuffer[0] == data[1]);
+        CHECK(bondReceiver.readSequenceNumber == 2);
+        thread.join();
+    }
+
+    SECTION("Test read of a frame larger than the buffer")
+    {
+        const uint8_t data[2] = { 0x11, 0x22 };
+
+        CHECK(sender->write(Hdlcpp::AddressBroadcast, data) == 2);
+        CHECK(sender->write(Hdlcpp::AddressBroadcast, { data, 1 }) == 1);
+        for (size_t i = 0; i < links; i++) {
+            while (receiver->receive(i).size > 0)
+                ;
+        }
+
+        // The frame is consumed anyway so the following frames are not blocked
+        CHECK(receiver->read({ dataBuffer, 1 }).size == -EMSGSIZE);
+        CHECK(receiver->read({ dataBuffer, 1 }).size == 1);
+        CHECK(dataBuffer[0] == 0x11);
+    }
+
+    SECTION("Test link selection weighted by throughput")
+    {
+        sender->linkRates = { 3000, 1000 };
+        CHECK(sender->selectLink(100, 0) == 0);
+
+        // The faster link completes later when it has more bytes queued
+        sender->linkQueued = { 300, 0 };
+        CHECK(sender->selectLink(100, 0) == 1);
+
+        // A link not measured yet is assumed to be as fast as the fastest link
+        sender->linkRates = { 3000, 0 };
+        sender->linkQueued = { 0, 0 };
+        CHECK(sender->selectLink(100, 1 << 0) == 1);
+        sender->linkQueued = { 100, 0 };
+        CHECK(sender->selectLink(100, 0) == 1);
+    }
+
+    SECTION("Test write fails over to another link")
+    {
+        const uint8_t data[1] = { 0x11 };
+
+        sender->linkRates = { 1000, 3000 };
+        failing[1] = true;
+
+        CHECK(sender->write(Hdlcpp::AddressBroadcast, data) == 1);
+        CHECK(wires[0].size() > 0);
+        CHECK(sender->rate(1) == 750);
+
+        failing[0] = true;
+        CHECK(sender->write(Hdlcpp::AddressBroadcast, data) < 0);
+        // The failed frame does not block the window
+        CHECK(sender->writeOldest == sender->writeSequenceNumber);
+    }
+
+    SECTION("Test close function")
+    {
+        receiver->close();
+        CHECK(receiver->read(dataBuffer).size == 0);
+        CHECK(receivers[0]->stopped);
+    }
+}
@@ -0,0 +1,173 @@
+#include "turtle/catch.hpp"
+#include <catch.hpp>
+
+#define protected public
+#include "CaptureDecoder.hpp"
+#include <vector>
+
+class CaptureDecoderFixture {
+public:
+    static constexpr uint16_t bufferSize = 64;
+
+    CaptureDecoderFixture()
+    {
+        // Write without waiting for acks to record a capture of the frames
+        hdlcpp = std::make_shared<Hdlcpp::Hdlcpp>(
+            [](Hdlcpp::Container) { return 0; },
+            [this](Hdlcpp::ConstContainer buffer) {
+                capture.insert(capture.end(), buffer.begin(), buffer.end());
+                return static_cast<int>(buffer.size());
+            },
+            readBuffer, writeBuffer, 0);
+    }
+
+    std::vector<Hdlcpp::CaptureDecoder::Record> decodeAll(Hdlcpp::CaptureDecoder& decoder, Hdlcpp::ConstContainer part, uint64_t offset)
+    {
+        std::vector<Hdlcpp::CaptureDecoder::Record> records;
+
+        decoder.decodeFrames(part, offset, [&records, this](const Hdlcpp::CaptureDecoder::Record& record) {
+            records.push_back(record);
+            // Keep a copy of the payload as the decoder reuses its buffer
+            payloads.emplace_back(record.data.begin(), record.data.end());
+        });
+
+        return records;
+    }
+
+    std::shared_ptr<Hdlcpp::Hdlcpp> hdlcpp;
+    Hdlcpp::StaticBuffer<Hdlcpp::Calculate<bufferSize>::WithOverhead> readBuffer {};
+    Hdlcpp::StaticBuffer<Hdlcpp::Calculate<bufferSize>::WithOverhead> writeBuffer {};
+    Hdlcpp::StaticBuffer<bufferSize> payloadBuffer {};
+    std::vector<uint8_t> capture;
+    std::vector<std::vector<uint8_t>> payloads;
+};
+
+TEST_CASE_METHOD(CaptureDecoderFixture, "capture decoder test", "[single-file]")
+{
+    Hdlcpp::CaptureDecoder decoder(payloadBuffer);
+
+    SECTION("Test boundary of consecutive flag sequences")
+    {
+        const std::vector<uint8_t> data = { 0x01, 0x7e, 0x7e, 0x7e, 0x02, 0x7e };
+
+        CHECK(decoder.boundary(data, 0) == 3);
+        CHECK(decoder.boundary(data, 4) == 5);
+        CHECK(decoder.boundary(data, 6) == data.size());
+        CHECK(decoder.boundary({ data.data(), 1 }, 0) == 1);
+    }
+
+    SECTION("Test decode of frames in a capture")
+    {
+        const uint8_t data[3] = { 0x11, 0x7e, 0x33 };
+
+        // Noise before the first frame and idle flag sequences between frames are skipped
+        capture = { 0x55, 0xaa };
+        CHECK(hdlcpp->write(0x10, data) == 3);
+        CHECK(hdlcpp->writeFrame(0x20, Hdlcpp::Hdlcpp::FrameAck, 2, {}) > 0);
+        capture.insert(capture.end(), { 0x7e, 0x7e });
+        const size_t corruptedOffset = capture.size();
+        CHECK(hdlcpp->write(0x30, { data, 1 }) == 1);
+        capture[corruptedOffset + 3] ^= 0x01;
+        // A frame not closed at the end of the capture is left for the next part
+        capture.insert(capture.end(), { 0x7e, 0x01, 0x02 });
+
+        const auto records = decodeAll(decoder, capture, 1000);
+        REQUIRE(records.size() == 3);
+
+        CHECK(records[0].offset == 1002);
+        CHECK(records[0].status == 3);
+        CHECK(records[0].address == 0x10);
+        CHECK(records[0].frame == Hdlcpp::Hdlcpp::FrameData);
+        CHECK(records[0].sequenceNumber == 1);
+        CHECK(payloads[0] == std::vector<uint8_t>(data, data + 3));
+
+        CHECK(records[1].offset == (records[0].offset + records[0].length - 1));
+        CHECK(records[1].status == 0);
+        CHECK(records[1].address == 0x20);
+        CHECK(records[1].frame == Hdlcpp::Hdlcpp::FrameAck);
+        CHECK(records[1].sequenceNumber == 2);
+        CHECK(std::string(decoder.frameName(records[1].frame)) == "ack");
+
+        // The closing flag sequence of the ack is followed by idle flag sequences
+        CHECK(records[2].offset == (corruptedOffset + 1000));
+        CHECK(records[2].status == -EIO);
+        CHECK(records[2].data.empty());
+    }
+
+    SECTION("Test decode of a capture split at any offset")
+    {
+        std::vector<uint8_t> data(bufferSize);
+
+        for (uint8_t i = 0; i < 8; i++) {
+            std::fill(data.begin(), data.end(), 0x7d + i);
+            CHECK(hdlcpp->write(i, { data.data(), static_cast<size_t>(1 + i * 7) }) > 0);
+            if (i % 3 == 0)
+                capture.push_back(0x7e);
+        }
+
+        const auto expected = decodeAll(decoder, capture, 0);
+        REQUIRE(expected.size() == 8);
+
+        // A frame straddling the split is decoded by the part holding its opening flag sequence
+        for (size_t split = 0; split < capture.size(); split++) {
+            const size_t boundary = decoder.boundary(capture, split);
+            const size_t firstSize = std::min(boundary + 1, capture.size());
+            const Hdlcpp::ConstContainer whole { capture };
+
+            auto records = decodeAll(decoder, whole.first(firstSize), 0);
+            if (boundary < capture.size()) {
+                const auto second = decodeAll(decoder, whole.subspan(boundary), boundary);
+                records.insert(records.end(), second.begin(), second.end());
+            }
+
+            REQUIRE(records.size() == expected.size());
+            for (size_t i = 0; i < records.size(); i++) {
+                CHECK(records[i].offset == expected[i].offset);
+                CHECK(records[i].length == expected[i].length);
+                CHECK(records[i].status == expected[i].status);
+                CHECK(records[i].address == expected[i].address);
+            }
+        }
+    }
+
+    SECTION("Test decode of a frame larger than the payload buffer")
+    {
+        std::vector<uint8_t> data(bufferSize);
+        uint8_t smallBuffer[8];
+        Hdlcpp::CaptureDecoder smallDecoder({ smallBuffer, sizeof(smallBuffer) });
+
+        CHECK(hdlcpp->write(0x10, data) == bufferSize);
+        CHECK(hdlcpp->write(0x10, { data.data(), 8 }) == 8);
+
+        const auto records = decodeAll(smallDecoder, capture, 0);
+        REQUIRE(records.size() == 2);
+        CHECK(records[0].status == -EMSGSIZE);
+        CHECK(records[0].data.empty());
+        CHECK(records[1].status == 8);
+    }
+
+    SECTION("Test decode of a frame too large for decode")
+    {
+        capture.push_back(0x7e);
+        capture.resize(0x10000, 0x11);
+        CHECK(hdlcpp->write(0x10, { payloadBuffer.data(), 1 }) == 1);
+
+        const auto records = decodeAll(decoder, capture, 0);
+        REQUIRE(records.size() == 2);
+        CHECK(records[0].offset == 0);
+        CHECK(records[0].length == 0x10001);
+        CHECK(records[0].status == -EMSGSIZE);
+        CHECK(records[1].offset == 0x10000);
+        CHECK(records[1].status == 1);
+    }
+
+    SECTION("Test frame values documented for the binary records of hdlcpp-decode")
+    {
+        CHECK(Hdlcpp::Hdlcpp::FrameData == 0);
+        CHECK(Hdlcpp::Hdlcpp::FrameAck == 1);
+        CHECK(Hdlcpp::Hdlcpp::FrameNack == 2);
+        CHECK(Hdlcpp::Hdlcpp::FrameReceiveNotReady == 3);
+        CHECK(Hdlcpp::Hdlcpp::FrameSelectiveReject == 4);
+        CHECK(Hdlcpp::Hdlcpp::FrameCompressedData == 5);
+    }
+}
@@ -0,0 +1,120 @@
+#include "turtle/catch.hpp"
+#include <catch.hpp>
+
+#define protected public
+#include "FramePool.hpp"
+#include <thread>
+#include <vector>
+
+TEST_CASE("frame pool test", "[single-file]")
+{
+    static constexpr size_t frameSize = Hdlcpp::Calculate<16>::WithOverhead;
+    static constexpr size_t frames = 4;
+    auto pool = std::make_unique<Hdlcpp::FramePool<frameSize, frames>>();
+
+    SECTION("Test acquire until the pool is exhausted")
+    {
+        std::vector<Hdlcpp::Container> buffers;
+
+        for (size_t i = 0; i < frames; i++) {
+            buffers.push_back(pool->acquire());
+            CHECK(buffers.back().size() == frameSize);
+        }
+
+        // The buffers do not overlap
+        for (size_t i = 1; i < frames; i++)
+            CHECK((buffers[i].data() - buffers[0].data()) % frameSize == 0);
+
+        // A failed acquire is only counted as exhausted
+        CHECK(pool->acquire().empty());
+        CHECK(pool->acquire().empty());
+        CHECK(pool->used() == frames);
+        CHECK(pool->peak() == frames);
+        CHECK(pool->exhausted() == 2);
+
+        CHECK(pool->release(buffers[2]) == 0);
+        CHECK(pool->used() == (frames - 1));
+        // The buffer released last is reused first
+        CHECK(pool->acquire().data() == buffers[2].data());
+    }
+
+    SECTION("Test release of buffers not from the pool")
+    {
+        uint8_t buffer[frameSize];
+        const auto acquired = pool->acquire();
+
+        CHECK(pool->release({}) == -EINVAL);
+        CHECK(pool->release(buffer) == -EINVAL);
+        CHECK(pool->release(acquired.subspan(1)) == -EINVAL);
+        CHECK(pool->release({ acquired.data() + (frames * frameSize), 1 }) == -EINVAL);
+        CHECK(pool->used() == 1);
+
+        // A buffer trimmed to the frame size is released as well
+        CHECK(pool->release(acquired.first(1)) == 0);
+        CHECK(pool->used() == 0);
+        CHECK(pool->peak() == 1);
+    }
+
+    SECTION("Test acquire and release from several threads")
+    {
+        std::vector<std::thread> threads;
+        std::atomic<size_t> conflicts { 0 };
+
+        for (uint8_t i = 1; i <= 4; i++) {
+            threads.emplace_back([&pool, &conflicts, i] {
+                for (int j = 0; j < 10000; j++) {
+                    auto buffer = pool->acquire();
+                    if (buffer.empty())
+                        continue;
+
+                    // A buffer is owned by a single thread until released
+                    std::fill(buffer.begin(), buffer.end(), i);
+                    std::this_thread::yield();
+                    if (std::any_of(buffer.begin(), buffer.end(), [i](uint8_t value) { return value != i; }))
+                        conflicts++;
+
+                    pool->release(buffer);
+                }
+            });
+        }
+
+        for (auto& thread : threads)
+            thread.join();
+
+        CHECK(conflicts == 0);
+        CHECK(pool->used() == 0);
+        CHECK(pool->peak() <= frames);
+    }
+
+    SECTION("Test occupancy never exceeds the buffers in use")
+    {
+        std::vector<std::thread> threads;
+        std::atomic<size_t> miscounts { 0 };
+        static constexpr size_t holders = 2;
+
+        // Each thread holds at most one buffer, so no more than two are ever in use
+        for (size_t i = 0; i < holders; i++) {
+            threads.emplace_back([&pool, &miscounts] {
+                for (int j = 0; j < 10000; j++) {
+                    auto buffer = pool->acquire();
+                    std::this_thread::yield();
+
+                    // The buffer held by this thread is counted and the count never exceeds the holders
+                    const size_t used { pool->used() };
+                    if ((used < 1) || (used > holders))
+                        miscounts++;
+
+                    pool->release(buffer);
+                }
+            });
+        }
+
+        for (auto& thread : threads)
+            thread.join();
+
+        CHECK(miscounts == 0);
+        CHECK(pool->used() == 0);
+        CHECK(pool->peak() <= holders);
+        CHECK(pool->exhausted() == 0);
+    }
+}
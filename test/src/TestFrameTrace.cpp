@@ -0,0 +1,164 @@
+#include "turtle/catch.hpp"
+#include <catch.hpp>
+
+#define protected public
+#include "TraceReplay.hpp"
+#include <vector>
+
+class FrameTraceFixture {
+public:
+    static constexpr uint16_t bufferSize = 64;
+
+    FrameTraceFixture()
+    {
+        hdlcpp = std::make_shared<Hdlcpp::Hdlcpp>(
+            [this](Hdlcpp::Container buffer) {
+                // Read a few bytes at a time like a UART
+                const size_t size = std::min({ buffer.size(), readData.size(), size_t(4) });
+                std::copy_n(readData.begin(), size, buffer.begin());
+                readData.erase(readData.begin(), readData.begin() + size);
+                return static_cast<int>(size);
+            },
+            [this](Hdlcpp::ConstContainer buffer) {
+                writeData.insert(writeData.end(), buffer.begin(), buffer.end());
+                return static_cast<int>(buffer.size());
+            },
+            readBuffer, writeBuffer, 1, 2);
+        hdlcpp->enableTrace(trace);
+    }
+
+    // Encodes a frame as sent by the peer
+    void receive(Hdlcpp::TransportAddress address, Hdlcpp::Hdlcpp::Frame frame, uint8_t sequenceNumber, std::vector<uint8_t> data = {})
+    {
+        Hdlcpp::StaticBuffer<Hdlcpp::Calculate<bufferSize>::WithOverhead> frameBuffer {};
+        const int size = hdlcpp->encode(address, frame, sequenceNumber, data, { frameBuffer });
+        readData.insert(readData.end(), frameBuffer.begin(), frameBuffer.begin() + size);
+    }
+
+    std::vector<Hdlcpp::FrameTrace::Event> dump(const Hdlcpp::FrameTrace& frameTrace)
+    {
+        std::vector<Hdlcpp::FrameTrace::Event> events(32);
+        events.resize(frameTrace.dump(events));
+        return events;
+    }
+
+    std::shared_ptr<Hdlcpp::Hdlcpp> hdlcpp;
+    Hdlcpp::StaticBuffer<Hdlcpp::Calculate<bufferSize>::WithOverhead> readBuffer {};
+    Hdlcpp::StaticBuffer<Hdlcpp::Calculate<bufferSize>::WithOverhead> writeBuffer {};
+    std::array<Hdlcpp::FrameTrace::Slot, 16> slots {};
+    Hdlcpp::FrameTrace trace { slots };
+    std::vector<uint8_t> readData;
+    std::vector<uint8_t> writeData;
+    uint8_t dataBuffer[bufferSize];
+};
+
+TEST_CASE_METHOD(FrameTraceFixture, "frame trace test", "[single-file]")
+{
+    SECTION("Test dump of events in chronological order")
+    {
+        trace.record(Hdlcpp::FrameTrace::DirectionTransmit, 0x10, 0x11, 1, 0);
+        trace.record(Hdlcpp::FrameTrace::DirectionReceive, 0x20, 0x21, 2, -EIO);
+        trace.record(Hdlcpp::FrameTrace::DirectionTransmit, 0x30, 0x31, 3, 0, 2);
+
+        const auto events = dump(trace);
+        REQUIRE(events.size() == 3);
+        CHECK(events[0].address == 0x10);
+        CHECK(events[0].direction == Hdlcpp::FrameTrace::DirectionTransmit);
+        CHECK(events[1].address == 0x20);
+        CHECK(events[1].control == 0x21);
+        CHECK(events[1].length == 2);
+        CHECK(events[1].result == -EIO);
+        CHECK(events[1].direction == Hdlcpp::FrameTrace::DirectionReceive);
+        CHECK(events[2].address == 0x30);
+        CHECK(events[2].retry == 2);
+        CHECK(events[0].timestamp <= events[1].timestamp);
+        CHECK(events[1].timestamp <= events[2].timestamp);
+    }
+
+    SECTION("Test dump of the most recent events")
+    {
+        for (uint8_t i = 0; i < 20; i++)
+            trace.record(Hdlcpp::FrameTrace::DirectionTransmit, i, 0, 0, 0);
+
+        // The oldest events have been overwritten
+        auto events = dump(trace);
+        REQUIRE(events.size() == (slots.size() / 2));
+        CHECK(events.front().address == 12);
+        CHECK(events.back().address == 19);
+        CHECK(trace.recorded() == 20);
+
+        std::array<Hdlcpp::FrameTrace::Event, 3> recent {};
+        REQUIRE(trace.dump(recent) == 3);
+        CHECK(recent[0].address == 17);
+        CHECK(recent[2].address == 19);
+    }
+
+    SECTION("Test trace of transmitted and received frames")
+    {
+        const uint8_t data[2] = { 0x11, 0x22 };
+
+        // No ack is received so the frame is retransmitted
+        CHECK(hdlcpp->write(0x10, data) == -ETIME);
+        receive(0x20, Hdlcpp::Hdlcpp::FrameData, 1, { 0x33 });
+        CHECK(hdlcpp->read(dataBuffer).size == 1);
+
+        const auto events = dump(trace);
+        REQUIRE(events.size() == 5);
+        for (uint8_t i = 0; i < 3; i++) {
+            CHECK(events[i].direction == Hdlcpp::FrameTrace::DirectionTransmit);
+            CHECK(events[i].control == Hdlcpp::Hdlcpp::encodeControlByte(Hdlcpp::Hdlcpp::FrameData, 1));
+            CHECK(events[i].length == 2);
+            CHECK(events[i].result == 0);
+            CHECK(events[i].retry == i);
+        }
+
+        CHECK(events[3].direction == Hdlcpp::FrameTrace::DirectionReceive);
+        CHECK(events[3].address == 0x20);
+        CHECK(events[3].length == 1);
+        // The received frame is acknowledged
+        CHECK(events[4].direction == Hdlcpp::FrameTrace::DirectionTransmit);
+        CHECK(events[4].control == Hdlcpp::Hdlcpp::encodeControlByte(Hdlcpp::Hdlcpp::FrameAck, 2));
+    }
+
+    SECTION("Test replay of a trace")
+    {
+        receive(0x20, Hdlcpp::Hdlcpp::FrameData, 1, { 0x11, 0x22, 0x33 });
+        receive(0x20, Hdlcpp::Hdlcpp::FrameData, 2, { 0x44 });
+        readData[readData.size() - 3] ^= 0x01;
+        receive(0x20, Hdlcpp::Hdlcpp::FrameData, 2, { 0x44 });
+        receive(0x20, Hdlcpp::Hdlcpp::FrameAck, 5);
+
+        CHECK(hdlcpp->read(dataBuffer).size == 3);
+        CHECK(hdlcpp->read(dataBuffer).size == 1);
+        CHECK(hdlcpp->read(dataBuffer).size == 0);
+        const auto recorded = dump(trace);
+
+        // Replay the trace through another instance recording its own trace
+        uint8_t payloadBuffer[bufferSize], frameBuffer[Hdlcpp::Calculate<bufferSize>::WithOverhead];
+        Hdlcpp::TraceReplay replay(recorded, payloadBuffer, frameBuffer);
+        std::array<Hdlcpp::FrameTrace::Slot, 16> replaySlots {};
+        Hdlcpp::FrameTrace replayTrace { replaySlots };
+        Hdlcpp::Hdlcpp replayHdlcpp([&replay](Hdlcpp::Container buffer) { return replay.readFrames(buffer); },
+            [](Hdlcpp::ConstContainer buffer) { return static_cast<int>(buffer.size()); }, readBuffer, writeBuffer);
+        replayHdlcpp.enableTrace(replayTrace);
+
+        CHECK(replayHdlcpp.read(dataBuffer).size == 3);
+        CHECK(replayHdlcpp.read(dataBuffer).size == 1);
+        CHECK(replayHdlcpp.read(dataBuffer).size == 0);
+        CHECK(replay.replayed() == recorded.size());
+
+        // The replaying instance received and answered the same frames
+        const auto replayed = dump(replayTrace);
+        REQUIRE(replayed.size() == recorded.size());
+        for (size_t i = 0; i < recorded.size(); i++) {
+            CHECK(replayed[i].direction == recorded[i].direction);
+            CHECK(replayed[i].address == recorded[i].address);
+            CHECK(replayed[i].control == recorded[i].control);
+            CHECK(replayed[i].length == recorded[i].length);
+            CHECK(replayed[i].result == recorded[i].result);
+        }
+
+        CHECK(recorded[2].result == -EIO);
+        CHECK(recorded[3].control == Hdlcpp::Hdlcpp::encodeControlByte(Hdlcpp::Hdlcpp::FrameNack, 2));
+    }
+}
@@ -3,6 +3,7 @@
 
 #define protected public
 #include "Hdlcpp.hpp"
+#include <thread>
 
 class HdlcppFixture {
     static constexpr uint16_t bufferSize = 64;
@@ -10,19 +11,33 @@ class HdlcppFixture {
 public:
     HdlcppFixture()
         : hdlcpp_writeBuffer(bufferSize)
+    {
+        create();
+    }
+
+    void create(uint8_t windowSize = 1)
     {
         hdlcpp = std::make_shared<Hdlcpp::Hdlcpp>(
             [this](Hdlcpp::Container buffer) { return transportRead(buffer); },
             [this](Hdlcpp::ConstContainer buffer) { return transportWrite(buffer); },
             hdlcpp_readBuffer,
             hdlcpp_writeBuffer,
-            1 // Use a 1 ms timeout to speed up tests
-        );
+            1, // Use a 1 ms timeout to speed up tests
+            1,
+            windowSize);
 
         // For testing only execute a single iteration instead of blocking
         hdlcpp->stopped = true;
     }
 
+    std::vector<uint8_t> encodeFrame(Hdlcpp::Hdlcpp::Frame frame, uint8_t sequenceNumber, Hdlcpp::ConstContainer data = {})
+    {
+        std::array<uint8_t, bufferSize> buffer {};
+        const int size = hdlcpp->encode(Hdlcpp::AddressBroadcast, frame, sequenceNumber, data, { buffer });
+
+        return { buffer.begin(), buffer.begin() + size };
+    }
+
     size_t transportRead(Hdlcpp::Container buffer)
     {
         std::memcpy(buffer.data(), readBuffer.data(), readBuffer.size());
@@ -99,6 +114,15 @@ TEST_CASE_METHOD(HdlcppFixture, "hdlcpp test", "[single-file]")
         CHECK(std::memcmp(frameNack, writeBuffer.data(), sizeof(frameNack)) == 0);
     }
 
+    SECTION("Test read of data frame larger than the buffer")
+    {
+        const uint8_t data[2] = { 0x11, 0x22 };
+
+        readBuffer = encodeFrame(Hdlcpp::Hdlcpp::FrameData, 1, data);
+        CHECK(hdlcpp->read({ dataBuffer, 1 }).size == -EMSGSIZE);
+        CHECK(dataBuffer[0] == data[0]);
+    }
+
     SECTION("Test read of two valid 1 byte data frames")
     {
         readBuffer.assign(frameData, frameData + sizeof(frameData));
@@ -181,6 +205,376 @@ TEST_CASE_METHOD(HdlcppFixture, "hdlcpp test", "[single-file]")
         CHECK(hdlcpp->writeResult == Hdlcpp::Hdlcpp::FrameNack);
     }
 
+    SECTION("Test read of receive not ready frame pauses write")
+    {
+        hdlcpp->writeSequenceNumber = 1;
+        readBuffer = encodeFrame(Hdlcpp::Hdlcpp::FrameReceiveNotReady, 2);
+        CHECK(hdlcpp->read(dataBuffer).size == 0);
+        CHECK(hdlcpp->writeResult == Hdlcpp::Hdlcpp::FrameReceiveNotReady);
+
+        // The write is paused until the peer is ready or the instance is closed
+        writeBuffer.clear();
+        CHECK(hdlcpp->write(Hdlcpp::AddressBroadcast, { &frameData[3], 1 }) == -EBUSY);
+        CHECK(writeBuffer.empty());
+
+        readBuffer.assign(frameAck, frameAck + sizeof(frameAck));
+        CHECK(hdlcpp->read(dataBuffer).size == 0);
+        CHECK(hdlcpp->write(Hdlcpp::AddressBroadcast, { &frameData[3], 1 }) == -ETIME);
+    }
+
+    SECTION("Test busy receiver discards data frames")
+    {
+        CHECK(hdlcpp->setBusy(Hdlcpp::AddressBroadcast, true) > 0);
+        CHECK(writeBuffer == encodeFrame(Hdlcpp::Hdlcpp::FrameReceiveNotReady, 1));
+
+        readBuffer.assign(frameData, frameData + sizeof(frameData));
+        CHECK(hdlcpp->read(dataBuffer).size == 0);
+        CHECK(writeBuffer == encodeFrame(Hdlcpp::Hdlcpp::FrameReceiveNotReady, 1));
+
+        CHECK(hdlcpp->setBusy(Hdlcpp::AddressBroadcast, false) > 0);
+        CHECK(writeBuffer == encodeFrame(Hdlcpp::Hdlcpp::FrameAck, 1));
+
+        CHECK(hdlcpp->read(dataBuffer).size == 1);
+        CHECK(std::memcmp(frameAck, writeBuffer.data(), sizeof(frameAck)) == 0);
+    }
+
+    SECTION("Test busy receiver does not acknowledge a missing frame")
+    {
+        create(4);
+        hdlcpp->readSequenceNumber = 2;
+        CHECK(hdlcpp->setBusy(Hdlcpp::AddressBroadcast, true) > 0);
+
+        // Frame 2 is lost and frame 3 is discarded, so the peer must keep both outstanding
+        readBuffer = encodeFrame(Hdlcpp::Hdlcpp::FrameData, 3, { &frameData[3], 1 });
+        CHECK(hdlcpp->read(dataBuffer).size == 0);
+        CHECK(writeBuffer == encodeFrame(Hdlcpp::Hdlcpp::FrameReceiveNotReady, 2));
+        CHECK(hdlcpp->readSequenceNumber == 2);
+        CHECK(hdlcpp->receiveMask == 0);
+
+        // At the sender the receive not ready does not acknowledge frames 2 and 3
+        hdlcpp->writeSequenceNumber = 4;
+        hdlcpp->writeOutstanding = 0x0c;
+        for (auto& state : hdlcpp->writeStates)
+            state = -1;
+
+        readBuffer = encodeFrame(Hdlcpp::Hdlcpp::FrameReceiveNotReady, 2);
+        CHECK(hdlcpp->read(dataBuffer).size == 0);
+        CHECK(hdlcpp->writeStates[2] == -1);
+        CHECK(hdlcpp->writeStates[3] == -1);
+    }
+
+    SECTION("Test congested read buffer pauses the peer")
+    {
+        hdlcpp->enableCongestionControl();
+        for (uint8_t i = 0; i < 12; i++)
+            readBuffer.insert(readBuffer.end(), frameData, frameData + sizeof(frameData));
+
+        CHECK(hdlcpp->read(dataBuffer).size == 1);
+        CHECK(writeBuffer == encodeFrame(Hdlcpp::Hdlcpp::FrameReceiveNotReady, 2));
+
+        // Consume the backlog without reading from the transport layer
+        readBuffer.clear();
+        while (hdlcpp->readBufferCongested())
+            CHECK(hdlcpp->read(dataBuffer).size == 1);
+
+        // Reading again lets the peer resume
+        CHECK(hdlcpp->read(dataBuffer).size == 1);
+        CHECK(hdlcpp->receiveNotReadySent == false);
+    }
+
+    SECTION("Test congested read buffer is acknowledged without congestion control")
+    {
+        for (uint8_t i = 0; i < 12; i++)
+            readBuffer.insert(readBuffer.end(), frameData, frameData + sizeof(frameData));
+
+        CHECK(hdlcpp->read(dataBuffer).size == 1);
+        CHECK(writeBuffer == encodeFrame(Hdlcpp::Hdlcpp::FrameAck, 2));
+        CHECK(hdlcpp->receiveNotReadySent == false);
+    }
+
+    SECTION("Test selective reject of a missing frame within the window")
+    {
+        create(4);
+        const uint8_t data[3] = { 0x11, 0x22, 0x33 };
+
+        readBuffer = encodeFrame(Hdlcpp::Hdlcpp::FrameData, 1, { &data[0], 1 });
+        CHECK(hdlcpp->read(dataBuffer).size == 1);
+        CHECK(writeBuffer == encodeFrame(Hdlcpp::Hdlcpp::FrameAck, 2));
+
+        // Frame 2 is lost so frame 3 is delivered and only frame 2 is requested again
+        readBuffer = encodeFrame(Hdlcpp::Hdlcpp::FrameData, 3, { &data[2], 1 });
+        CHECK(hdlcpp->read(dataBuffer).size == 1);
+        CHECK(dataBuffer[0] == data[2]);
+        CHECK(writeBuffer == encodeFrame(Hdlcpp::Hdlcpp::FrameSelectiveReject, 2));
+
+        // The retransmitted frame acknowledges both frames
+        readBuffer = encodeFrame(Hdlcpp::Hdlcpp::FrameData, 2, { &data[1], 1 });
+        CHECK(hdlcpp->read(dataBuffer).size == 1);
+        CHECK(dataBuffer[0] == data[1]);
+        CHECK(writeBuffer == encodeFrame(Hdlcpp::Hdlcpp::FrameAck, 4));
+
+        // A duplicate is not delivered again
+        readBuffer = encodeFrame(Hdlcpp::Hdlcpp::FrameData, 3, { &data[2], 1 });
+        CHECK(hdlcpp->read(dataBuffer).size == 0);
+        CHECK(writeBuffer == encodeFrame(Hdlcpp::Hdlcpp::FrameAck, 4));
+    }
+
+    SECTION("Test selective reject only retransmits the missing frame")
+    {
+        create(4);
+        hdlcpp->writeSequenceNumber = 4;
+        hdlcpp->writeOutstanding = 0x1e;
+        for (auto& state : hdlcpp->writeStates)
+            state = -1;
+
+        CHECK_FALSE(hdlcpp->writeWindowAvailable());
+
+        readBuffer = encodeFrame(Hdlcpp::Hdlcpp::FrameSelectiveReject, 2);
+        CHECK(hdlcpp->read(dataBuffer).size == 0);
+        CHECK(hdlcpp->writeStates[1] == -1);
+        CHECK(hdlcpp->writeStates[2] == Hdlcpp::Hdlcpp::FrameSelectiveReject);
+        CHECK(hdlcpp->writeStates[3] == -1);
+
+        readBuffer = encodeFrame(Hdlcpp::Hdlcpp::FrameAck, 2);
+        CHECK(hdlcpp->read(dataBuffer).size == 0);
+        CHECK(hdlcpp->writeStates[1] == Hdlcpp::Hdlcpp::FrameAck);
+        CHECK(hdlcpp->writeStates[3] == -1);
+    }
+
+    SECTION("Test window of priority classes")
+    {
+        CHECK(hdlcpp->window(Hdlcpp::PriorityHigh) == 1);
+        CHECK(hdlcpp->window(Hdlcpp::PriorityNormal) == 1);
+        CHECK(hdlcpp->window(Hdlcpp::PriorityBulk) == 1);
+
+        create(4);
+        CHECK(hdlcpp->window(Hdlcpp::PriorityHigh) == 4);
+        CHECK(hdlcpp->window(Hdlcpp::PriorityNormal) == 3);
+        CHECK(hdlcpp->window(Hdlcpp::PriorityBulk) == 3);
+    }
+
+    SECTION("Test write with invalid priority")
+    {
+        CHECK(hdlcpp->write(Hdlcpp::AddressBroadcast, { &frameData[3], 1 }, static_cast<Hdlcpp::Priority>(Hdlcpp::PriorityClasses)) == -EINVAL);
+    }
+
+    SECTION("Test high priority write is not queued behind frames in flight")
+    {
+        create(4);
+
+        // Frames with sequence numbers 1 to 3 are waiting to be acknowledged
+        hdlcpp->writeSequenceNumber = 3;
+        hdlcpp->writeOutstanding = 0x0e;
+        for (auto& state : hdlcpp->writeStates)
+            state = -1;
+
+        CHECK_FALSE(hdlcpp->writeWindowAvailable(Hdlcpp::PriorityNormal));
+        CHECK(hdlcpp->writeWindowAvailable(Hdlcpp::PriorityHigh));
+
+        CHECK(hdlcpp->write(Hdlcpp::AddressBroadcast, { &frameData[3], 1 }, Hdlcpp::PriorityHigh) == -ETIME);
+        CHECK(writeBuffer == encodeFrame(Hdlcpp::Hdlcpp::FrameData, 4, { &frameData[3], 1 }));
+    }
+
+    SECTION("Test stop-and-wait keeps a single frame in flight for all priority classes")
+    {
+        int result { 0 };
+
+        CHECK(hdlcpp->writeAsync(Hdlcpp::AddressBroadcast, { &frameData[3], 1 }, Hdlcpp::PriorityBulk) == 1);
+        CHECK_FALSE(hdlcpp->writeWindowAvailable(Hdlcpp::PriorityHigh));
+
+        // The high priority frame is only sent once the frame in flight has been acknowledged
+        std::thread writer([&] { result = hdlcpp->writeAsync(Hdlcpp::AddressBroadcast, { &frameData[3], 1 }, Hdlcpp::PriorityHigh); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        CHECK(hdlcpp->writeOutstanding == 0x02);
+
+        readBuffer = encodeFrame(Hdlcpp::Hdlcpp::FrameAck, 2);
+        CHECK(hdlcpp->read(dataBuffer).size == 0);
+        CHECK(hdlcpp->writeWait(1) == 1);
+
+        writer.join();
+        CHECK(result == 2);
+        CHECK(writeBuffer == encodeFrame(Hdlcpp::Hdlcpp::FrameData, 2, { &frameData[3], 1 }));
+
+        // Each frame is acknowledged on its own so nothing is retransmitted
+        readBuffer = encodeFrame(Hdlcpp::Hdlcpp::FrameAck, 3);
+        CHECK(hdlcpp->read(dataBuffer).size == 0);
+        CHECK(hdlcpp->writeWait(2) == 1);
+        CHECK(hdlcpp->writeRetransmissions[1] == 0);
+        CHECK(hdlcpp->writeRetransmissions[2] == 0);
+    }
+
+    SECTION("Test lower priority frame gives way to a waiting higher priority frame")
+    {
+        hdlcpp->transmitWaiting[Hdlcpp::PriorityHigh] = 1;
+        CHECK(hdlcpp->transmitWaitingHigherPriority(Hdlcpp::PriorityBulk));
+        CHECK_FALSE(hdlcpp->transmitWaitingHigherPriority(Hdlcpp::PriorityHigh));
+
+        // The delay is bounded by the write timeout
+        CHECK(hdlcpp->writeFrame(Hdlcpp::AddressBroadcast, Hdlcpp::Hdlcpp::FrameData, 1, { &frameData[3], 1 }, Hdlcpp::PriorityBulk) == sizeof(frameData));
+        CHECK(std::memcmp(frameData, writeBuffer.data(), sizeof(frameData)) == 0);
+    }
+
+    SECTION("Test write/read of a compressed data frame")
+    {
+        std::array<uint8_t, Hdlcpp::Lz::WorkspaceSize> workspace {};
+        std::array<uint8_t, 64> writeCompressed {}, readCompressed {}, buffer {};
+        std::vector<uint8_t> data(48, 0x11);
+
+        hdlcpp->enableCompression(workspace, writeCompressed, readCompressed);
+        hdlcpp->write(Hdlcpp::AddressBroadcast, data);
+        CHECK(writeBuffer.size() < data.size());
+        CHECK(writeBuffer[2] & (1 << Hdlcpp::Hdlcpp::ControlCompressedBit));
+
+        readBuffer = writeBuffer;
+        CHECK(hdlcpp->read(buffer).size == static_cast<int>(data.size()));
+        CHECK(std::equal(data.begin(), data.end(), buffer.begin()));
+    }
+
+    SECTION("Test read of a corrupted compressed data frame is rejected")
+    {
+        std::array<uint8_t, Hdlcpp::Lz::WorkspaceSize> workspace {};
+        std::array<uint8_t, 64> writeCompressed {}, readCompressed {}, buffer {};
+        // A match with an offset before the start of the data
+        const uint8_t data[4] = { 0x10, 0x11, 0x05, 0x00 };
+
+        hdlcpp->enableCompression(workspace, writeCompressed, readCompressed);
+        readBuffer = encodeFrame(Hdlcpp::Hdlcpp::FrameCompressedData, 1, data);
+        CHECK(hdlcpp->read(buffer).size == -EIO);
+        CHECK(writeBuffer == encodeFrame(Hdlcpp::Hdlcpp::FrameNack, 1));
+        CHECK(hdlcpp->readSequenceNumber == 1);
+    }
+
+    SECTION("Test write of an incompressible data frame sends it as is")
+    {
+        std::array<uint8_t, Hdlcpp::Lz::WorkspaceSize> workspace {};
+        std::array<uint8_t, 64> writeCompressed {}, readCompressed {};
+
+        hdlcpp->enableCompression(workspace, writeCompressed, readCompressed);
+        hdlcpp->write(Hdlcpp::AddressBroadcast, { &frameData[3], 1 });
+        CHECK(std::memcmp(frameData, writeBuffer.data(), sizeof(frameData)) == 0);
+    }
+
+    SECTION("Test read of a compressed flag without compression enabled")
+    {
+        const uint8_t data[1] = { 0x55 };
+
+        // The receive sequence number of I-frames is ignored without compression enabled
+        readBuffer = encodeFrame(Hdlcpp::Hdlcpp::FrameCompressedData, 1, data);
+        CHECK(hdlcpp->read(dataBuffer).size == 1);
+        CHECK(dataBuffer[0] == data[0]);
+    }
+
+    SECTION("Test encode/decode of compressed data frames")
+    {
+        const uint8_t encodeSequenceNumber { GENERATE(range<uint8_t>(0, 8)) };
+        Hdlcpp::Hdlcpp::Frame decodeFrame = Hdlcpp::Hdlcpp::FrameAck;
+        uint8_t decodeSequenceNumber = 0;
+
+        Hdlcpp::Hdlcpp::decodeControlByte(Hdlcpp::Hdlcpp::encodeControlByte(Hdlcpp::Hdlcpp::FrameCompressedData, encodeSequenceNumber), decodeFrame, decodeSequenceNumber);
+        CHECK(decodeFrame == Hdlcpp::Hdlcpp::FrameCompressedData);
+        CHECK(decodeSequenceNumber == encodeSequenceNumber);
+    }
+
+    SECTION("Test encode/decode of supervisory frames")
+    {
+        const auto encodeFrame { GENERATE(Hdlcpp::Hdlcpp::FrameAck, Hdlcpp::Hdlcpp::FrameNack, Hdlcpp::Hdlcpp::FrameReceiveNotReady, Hdlcpp::Hdlcpp::FrameSelectiveReject) };
+        const uint8_t encodeSequenceNumber { GENERATE(range<uint8_t>(0, 8)) };
+        Hdlcpp::Hdlcpp::Frame decodeFrame = Hdlcpp::Hdlcpp::FrameData;
+        uint8_t decodeSequenceNumber = 0;
+
+        Hdlcpp::Hdlcpp::decodeControlByte(Hdlcpp::Hdlcpp::encodeControlByte(encodeFrame, encodeSequenceNumber), decodeFrame, decodeSequenceNumber);
+        CHECK(decodeFrame == encodeFrame);
+        CHECK(decodeSequenceNumber == encodeSequenceNumber);
+    }
+
+    SECTION("Test supervisory frames encoded in advance")
+    {
+        const auto frame { GENERATE(Hdlcpp::Hdlcpp::FrameAck, Hdlcpp::Hdlcpp::FrameNack, Hdlcpp::Hdlcpp::FrameReceiveNotReady, Hdlcpp::Hdlcpp::FrameSelectiveReject) };
+        const uint8_t sequenceNumber { GENERATE(range<uint8_t>(0, 8)) };
+
+        for (uint16_t address = 0; address <= 0xff; address++) {
+            std::array<uint8_t, Hdlcpp::Calculate<0>::SupervisoryFrame> buffer {};
+            Hdlcpp::Hdlcpp::Frame encodeFrame { frame };
+            uint8_t encodeSequenceNumber { sequenceNumber };
+            const int size = hdlcpp->encode(address, encodeFrame, encodeSequenceNumber, {}, { buffer });
+
+            const auto encoded { hdlcpp->supervisoryFrame(address, frame, sequenceNumber) };
+            REQUIRE(static_cast<int>(encoded.size()) == size);
+            CHECK(std::equal(encoded.begin(), encoded.end(), buffer.begin()));
+        }
+
+        CHECK(hdlcpp->supervisoryFrame(Hdlcpp::AddressBroadcast, Hdlcpp::Hdlcpp::FrameData, sequenceNumber).empty());
+        CHECK(hdlcpp->supervisoryFrame(Hdlcpp::AddressBroadcast, Hdlcpp::Hdlcpp::FrameCompressedData, sequenceNumber).empty());
+    }
+
+    SECTION("Test supervisory frames alternating between addresses are encoded one at a time")
+    {
+        const auto& cache { hdlcpp->supervisoryFrameCache };
+        const uint8_t ack1 { hdlcpp->supervisoryFrameIndex(Hdlcpp::Hdlcpp::FrameAck, 1) };
+        const uint8_t ack2 { hdlcpp->supervisoryFrameIndex(Hdlcpp::Hdlcpp::FrameAck, 2) };
+
+        hdlcpp->supervisoryFrame(0x10, Hdlcpp::Hdlcpp::FrameAck, 1);
+        hdlcpp->supervisoryFrame(0x20, Hdlcpp::Hdlcpp::FrameAck, 1);
+        hdlcpp->supervisoryFrame(0x10, Hdlcpp::Hdlcpp::FrameAck, 2);
+
+        // Only the frames sent have been encoded, for the address they were last sent to
+        for (uint8_t i = 0; i < cache.size(); i++) {
+            const int16_t address { (i == ack1) ? int16_t(0x20) : ((i == ack2) ? int16_t(0x10) : int16_t(-1)) };
+            CHECK(cache[i].address == address);
+        }
+
+        std::array<uint8_t, Hdlcpp::Calculate<0>::SupervisoryFrame> buffer {};
+        Hdlcpp::Hdlcpp::Frame frame { Hdlcpp::Hdlcpp::FrameAck };
+        uint8_t sequenceNumber { 1 };
+        const int size = hdlcpp->encode(0x10, frame, sequenceNumber, {}, { buffer });
+
+        const auto encoded { hdlcpp->supervisoryFrame(0x10, Hdlcpp::Hdlcpp::FrameAck, 1) };
+        CHECK(cache[ack1].address == 0x10);
+        REQUIRE(static_cast<int>(encoded.size()) == size);
+        CHECK(std::equal(encoded.begin(), encoded.end(), buffer.begin()));
+    }
+
+    SECTION("Test ack is sent without using the writeBuffer")
+    {
+        std::fill(hdlcpp_writeBuffer.begin(), hdlcpp_writeBuffer.end(), 0x55);
+
+        readBuffer.assign(frameData, frameData + sizeof(frameData));
+        CHECK(hdlcpp->read(dataBuffer).size == 1);
+        CHECK(std::memcmp(frameAck, writeBuffer.data(), sizeof(frameAck)) == 0);
+        CHECK(std::all_of(hdlcpp_writeBuffer.begin(), hdlcpp_writeBuffer.end(), [](uint8_t value) { return value == 0x55; }));
+    }
+
+    SECTION("Test frame size bounds are exact")
+    {
+        // The smallest payload size for which a frame has all of its address, data and FCS bytes escaped
+        static constexpr size_t capacity { 10 };
+        std::array<uint8_t, Hdlcpp::Calculate<capacity>::DataFrame> buffer {};
+        std::array<uint8_t, capacity> data {};
+        size_t dataFrame { 0 }, supervisoryFrame { 0 };
+
+        for (uint8_t sequenceNumber = 0; sequenceNumber < 8; sequenceNumber++) {
+            for (const uint8_t address : { Hdlcpp::Hdlcpp::FlagSequence, Hdlcpp::Hdlcpp::ControlEscape }) {
+                for (uint16_t escaped = 0; escaped < (1 << capacity); escaped++) {
+                    for (size_t i = 0; i < capacity; i++)
+                        data[i] = ((escaped >> i) & 0x1) ? Hdlcpp::Hdlcpp::FlagSequence : Hdlcpp::Hdlcpp::ControlEscape;
+
+                    const int size = hdlcpp->encodeFrame(address, Hdlcpp::Hdlcpp::FrameData, sequenceNumber, data, { buffer });
+                    REQUIRE(size > 0);
+                    dataFrame = std::max<size_t>(dataFrame, size);
+                }
+            }
+
+            for (uint8_t frame = Hdlcpp::Hdlcpp::FrameAck; frame <= Hdlcpp::Hdlcpp::FrameSelectiveReject; frame++) {
+                for (uint16_t address = 0; address <= 0xff; address++)
+                    supervisoryFrame = std::max(supervisoryFrame,
+                        hdlcpp->supervisoryFrame(address, static_cast<Hdlcpp::Hdlcpp::Frame>(frame), sequenceNumber).size());
+            }
+        }
+
+        CHECK(dataFrame == Hdlcpp::Calculate<capacity>::DataFrame);
+        CHECK(supervisoryFrame == Hdlcpp::Calculate<capacity>::SupervisoryFrame);
+    }
+
     SECTION("Test encode/decode functions with 1 byte data and varying addresses")
     {
         const uint8_t encodedAddress { GENERATE(range<uint8_t>(0x0, 0xff)) };
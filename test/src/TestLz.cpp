@@ -0,0 +1,129 @@
+#include "turtle/catch.hpp"
+#include <catch.hpp>
+
+#define protected public
+#include "Lz.hpp"
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+class LzFixture {
+public:
+    LzFixture()
+        : compressed(512)
+        , decompressed(512)
+    {
+    }
+
+    int roundTrip(const std::vector<uint8_t>& data)
+    {
+        int size;
+
+        if ((size = Hdlcpp::Lz::compress(data, compressed, workspace)) < 0)
+            return size;
+
+        compressed.resize(size);
+        if ((size = Hdlcpp::Lz::decompress(compressed, decompressed)) < 0)
+            return size;
+
+        decompressed.resize(size);
+        return (decompressed == data) ? static_cast<int>(compressed.size()) : -EIO;
+    }
+
+    std::array<uint8_t, Hdlcpp::Lz::WorkspaceSize> workspace {};
+    std::vector<uint8_t> compressed;
+    std::vector<uint8_t> decompressed;
+};
+
+TEST_CASE_METHOD(LzFixture, "lz test", "[single-file]")
+{
+    SECTION("Test compress/decompress with invalid input")
+    {
+        const uint8_t data[1] {};
+        CHECK(Hdlcpp::Lz::compress({}, compressed, workspace) == -EINVAL);
+        CHECK(Hdlcpp::Lz::compress(data, compressed, {}) == -EINVAL);
+        CHECK(Hdlcpp::Lz::decompress({}, decompressed) == -EINVAL);
+        CHECK(Hdlcpp::Lz::decompress(data, {}) == -EINVAL);
+    }
+
+    SECTION("Test compress/decompress of repetitive data")
+    {
+        const std::vector<uint8_t> data(300, 0xaa);
+
+        // The match length is extended beyond the token nibble
+        const int size = roundTrip(data);
+        CHECK(size > 0);
+        CHECK(size < 16);
+    }
+
+    SECTION("Test compress follows the LZ4 end of block restrictions")
+    {
+        const std::vector<uint8_t> data(64, 0xaa);
+        CHECK(roundTrip(data) > 0);
+
+        // A literal with a match of the following 58 bytes (offset 1) and the last 5 bytes as literals
+        const std::vector<uint8_t> expected { 0x1f, 0xaa, 0x01, 0x00, 58 - 4 - 15, 0x50, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa };
+        CHECK(compressed == expected);
+    }
+
+    SECTION("Test compress/decompress of text")
+    {
+        const std::string text { "{\"volume\":42,\"mute\":false},{\"volume\":43,\"mute\":false},{\"volume\":44,\"mute\":true}" };
+        const std::vector<uint8_t> data(text.begin(), text.end());
+
+        const int size = roundTrip(data);
+        CHECK(size > 0);
+        CHECK(size < static_cast<int>(data.size()));
+    }
+
+    SECTION("Test compress/decompress of more than 15 literals")
+    {
+        std::vector<uint8_t> data(100);
+        std::iota(data.begin(), data.begin() + 40, 0);
+        std::iota(data.begin() + 40, data.end(), 0);
+
+        CHECK(roundTrip(data) > 0);
+    }
+
+    SECTION("Test compress of incompressible data does not fit")
+    {
+        std::vector<uint8_t> data(256);
+        std::mt19937 generator(1);
+        std::generate(data.begin(), data.end(), [&generator]() { return generator() & 0xff; });
+
+        CHECK(Hdlcpp::Lz::compress(data, std::span(compressed).first(data.size() - 1), workspace) == -ENOSPC);
+        CHECK(roundTrip(data) > static_cast<int>(data.size()));
+    }
+
+    SECTION("Test compress with a small workspace")
+    {
+        const std::vector<uint8_t> data(100, 0x55);
+
+        CHECK(Hdlcpp::Lz::compress(data, compressed, std::span(workspace).first(2)) > 0);
+    }
+
+    SECTION("Test decompress into a too small buffer")
+    {
+        const std::vector<uint8_t> data(100, 0x55);
+        const int size = Hdlcpp::Lz::compress(data, compressed, workspace);
+
+        CHECK(Hdlcpp::Lz::decompress(std::span(compressed).first(size), std::span(decompressed).first(99)) == -EMSGSIZE);
+    }
+
+    SECTION("Test decompress of malformed data")
+    {
+        // Literals beyond the end of the source
+        const uint8_t literals[2] = { 0x20, 0x11 };
+        CHECK(Hdlcpp::Lz::decompress(literals, decompressed) == -EIO);
+        // Offset pointing before the start of the output
+        const uint8_t offset[4] = { 0x10, 0x11, 0x02, 0x00 };
+        CHECK(Hdlcpp::Lz::decompress(offset, decompressed) == -EIO);
+        // Truncated offset
+        const uint8_t truncated[3] = { 0x10, 0x11, 0x01 };
+        CHECK(Hdlcpp::Lz::decompress(truncated, decompressed) == -EIO);
+        // Truncated length extension
+        const uint8_t extension[1] = { 0xf0 };
+        CHECK(Hdlcpp::Lz::decompress(extension, decompressed) == -EIO);
+    }
+}
@@ -0,0 +1,232 @@
+#include "turtle/catch.hpp"
+#include <catch.hpp>
+
+#define protected public
+#include "MessageLayer.hpp"
+#include <deque>
+#include <numeric>
+
+class MessageLayerFixture {
+    static constexpr uint16_t bufferSize = 64;
+
+public:
+    MessageLayerFixture()
+        : message(2000)
+    {
+        // The sender does not wait for acks and the receiver reads the encoded fragments from the wire,
+        // so a test can deliver, drop or repeat single fragments before reading the message
+        sender = std::make_shared<Hdlcpp::Hdlcpp>(
+            [](Hdlcpp::Container) { return 0; },
+            [this](Hdlcpp::ConstContainer buffer) { return transportWrite(buffer); },
+            sender_readBuffer, sender_writeBuffer, 0);
+        receiver = std::make_shared<Hdlcpp::Hdlcpp>(
+            [this](Hdlcpp::Container buffer) { return transportRead(buffer); },
+            [](Hdlcpp::ConstContainer buffer) { return static_cast<int>(buffer.size()); },
+            receiver_readBuffer, receiver_writeBuffer, 0);
+        receiver->stopped = true;
+
+        senderLayer = std::make_shared<Hdlcpp::MessageLayer>(*sender, sender_fragmentBuffer, sender_fragmentBuffer);
+        receiverLayer = std::make_shared<Hdlcpp::MessageLayer>(*receiver, receiver_fragmentBuffer, receiver_fragmentBuffer);
+
+        std::iota(message.begin(), message.end(), 0);
+    }
+
+    int transportRead(Hdlcpp::Container buffer)
+    {
+        size_t size = 0;
+        while ((size < buffer.size()) && !wire.empty()) {
+            buffer[size++] = wire.front();
+            wire.pop_front();
+        }
+
+        return size;
+    }
+
+    int transportWrite(Hdlcpp::ConstContainer buffer)
+    {
+        wire.insert(wire.end(), buffer.begin(), buffer.end());
+        return buffer.size();
+    }
+
+    // Takes the encoded fragments from the wire (each is written as a single frame)
+    std::vector<std::vector<uint8_t>> takeFrames()
+    {
+        std::vector<std::vector<uint8_t>> frames;
+
+        while (!wire.empty()) {
+            const auto frameEnd { std::find(wire.begin() + 1, wire.end(), 0x7e) + 1 };
+            frames.emplace_back(wire.begin(), frameEnd);
+            wire.erase(wire.begin(), frameEnd);
+        }
+
+        return frames;
+    }
+
+    void send(const std::vector<uint8_t>& frame)
+    {
+        wire.insert(wire.end(), frame.begin(), frame.end());
+    }
+
+    std::shared_ptr<Hdlcpp::Hdlcpp> sender;
+    std::shared_ptr<Hdlcpp::Hdlcpp> receiver;
+    std::shared_ptr<Hdlcpp::MessageLayer> senderLayer;
+    std::shared_ptr<Hdlcpp::MessageLayer> receiverLayer;
+    Hdlcpp::StaticBuffer<Hdlcpp::Calculate<bufferSize>::WithOverhead> sender_readBuffer {};
+    Hdlcpp::StaticBuffer<Hdlcpp::Calculate<bufferSize>::WithOverhead> sender_writeBuffer {};
+    Hdlcpp::StaticBuffer<Hdlcpp::Calculate<bufferSize>::WithOverhead> receiver_readBuffer {};
+    Hdlcpp::StaticBuffer<Hdlcpp::Calculate<bufferSize>::WithOverhead> receiver_writeBuffer {};
+    Hdlcpp::StaticBuffer<bufferSize> sender_fragmentBuffer {};
+    Hdlcpp::StaticBuffer<bufferSize> receiver_fragmentBuffer {};
+    std::deque<uint8_t> wire;
+    std::vector<uint8_t> message;
+};
+
+TEST_CASE_METHOD(MessageLayerFixture, "message layer test", "[single-file]")
+{
+    SECTION("Test write/read with invalid input")
+    {
+        uint8_t data[1] {};
+        CHECK(senderLayer->write(Hdlcpp::AddressBroadcast, { data, 0 }) == -EINVAL);
+        CHECK(senderLayer->write(Hdlcpp::AddressBroadcast, {}) == -EINVAL);
+        CHECK(receiverLayer->read(Hdlcpp::Container {}).size == -EINVAL);
+        CHECK(receiverLayer->read(Hdlcpp::MessageSink {}).size == -EINVAL);
+    }
+
+    SECTION("Test write/read of a message larger than a frame")
+    {
+        CHECK(senderLayer->write(Hdlcpp::AddressBroadcast, message) == static_cast<int>(message.size()));
+
+        std::vector<uint8_t> buffer(message.size());
+        CHECK(receiverLayer->read(buffer).size == static_cast<int>(message.size()));
+        CHECK(buffer == message);
+        CHECK(wire.empty());
+    }
+
+    SECTION("Test write/read of a message smaller than a frame")
+    {
+        CHECK(senderLayer->write(Hdlcpp::AddressBroadcast, { message.data(), 3 }) == 3);
+
+        std::vector<uint8_t> buffer(16);
+        CHECK(receiverLayer->read(buffer).size == 3);
+        CHECK(std::equal(buffer.begin(), buffer.begin() + 3, message.begin()));
+    }
+
+    SECTION("Test read of a message streamed to a sink")
+    {
+        std::vector<uint8_t> buffer(message.size());
+        size_t fragments = 0;
+
+        CHECK(senderLayer->write(Hdlcpp::AddressBroadcast, message) == static_cast<int>(message.size()));
+        CHECK(receiverLayer->read([&](size_t offset, Hdlcpp::ConstContainer data) {
+            std::copy(data.begin(), data.end(), buffer.begin() + offset);
+            fragments++;
+            return 0;
+        }).size == static_cast<int>(message.size()));
+
+        CHECK(buffer == message);
+        CHECK(fragments == ((message.size() + 57) / 58));
+    }
+
+    SECTION("Test read of a message larger than the buffer")
+    {
+        std::vector<uint8_t> buffer(message.size() / 2);
+
+        CHECK(senderLayer->write(Hdlcpp::AddressBroadcast, message) == static_cast<int>(message.size()));
+        CHECK(receiverLayer->read(buffer).size == -EMSGSIZE);
+        // The remaining fragments of the aborted message are discarded
+        CHECK(receiverLayer->read(buffer).size == 0);
+        CHECK(wire.empty());
+
+        CHECK(senderLayer->write(Hdlcpp::AddressBroadcast, { message.data(), buffer.size() }) == static_cast<int>(buffer.size()));
+        CHECK(receiverLayer->read(buffer).size == static_cast<int>(buffer.size()));
+    }
+
+    SECTION("Test read of repeated fragments from a retransmission")
+    {
+        CHECK(senderLayer->write(Hdlcpp::AddressBroadcast, { message.data(), 100 }) == 100);
+
+        // Repeat the first frame as if its ack was lost
+        const auto frameEnd { std::find(wire.begin() + 1, wire.end(), 0x7e) + 1 };
+        wire.insert(frameEnd, wire.begin(), frameEnd);
+
+        std::vector<uint8_t> buffer(100);
+        CHECK(receiverLayer->read(buffer).size == 100);
+        CHECK(std::equal(buffer.begin(), buffer.end(), message.begin()));
+    }
+
+    SECTION("Test read of a repeated fragment while a fragment is missing")
+    {
+        CHECK(senderLayer->write(Hdlcpp::AddressBroadcast, { message.data(), 150 }) == 150);
+        const auto frames { takeFrames() };
+        REQUIRE(frames.size() == 3);
+
+        // The second fragment is lost and the first one is repeated, which must not complete the message
+        send(frames[0]);
+        send(frames[2]);
+        send(frames[0]);
+
+        std::vector<uint8_t> buffer(150);
+        CHECK(receiverLayer->read(buffer).size == 0);
+
+        send(frames[1]);
+        CHECK(receiverLayer->read(buffer).size == 150);
+        CHECK(std::equal(buffer.begin(), buffer.end(), message.begin()));
+    }
+
+    SECTION("Test read of fragments out of order")
+    {
+        CHECK(senderLayer->write(Hdlcpp::AddressBroadcast, { message.data(), 200 }) == 200);
+        const auto frames { takeFrames() };
+        REQUIRE(frames.size() == 4);
+
+        for (const size_t i : { 3, 1, 3, 0, 1, 2 })
+            send(frames[i]);
+
+        std::vector<uint8_t> buffer(200);
+        CHECK(receiverLayer->read(buffer).size == 200);
+        CHECK(std::equal(buffer.begin(), buffer.end(), message.begin()));
+    }
+
+    SECTION("Test read of a message from a restarted sender")
+    {
+        std::vector<uint8_t> buffer(100);
+        CHECK(senderLayer->write(Hdlcpp::AddressBroadcast, { message.data(), 100 }) == 100);
+        CHECK(receiverLayer->read(buffer).size == 100);
+
+        // The restarted sender uses the same message id but another session
+        Hdlcpp::MessageLayer restartedLayer(*sender, sender_fragmentBuffer, sender_fragmentBuffer);
+        restartedLayer.writeSession = (senderLayer->writeSession + 1) & Hdlcpp::MessageLayer::FragmentSessionMask;
+        CHECK(restartedLayer.write(Hdlcpp::AddressBroadcast, { message.data() + 100, 100 }) == 100);
+        CHECK(receiverLayer->read(buffer).size == 100);
+        CHECK(std::equal(buffer.begin(), buffer.end(), message.begin() + 100));
+    }
+
+    SECTION("Test read of messages with the same id from different addresses")
+    {
+        Hdlcpp::MessageLayer otherLayer(*sender, sender_fragmentBuffer, sender_fragmentBuffer);
+        otherLayer.writeSession = senderLayer->writeSession;
+        std::vector<uint8_t> otherMessage(message.rbegin(), message.rbegin() + 100);
+
+        CHECK(senderLayer->write(0x10, { message.data(), 100 }) == 100);
+        const auto frames { takeFrames() };
+        CHECK(otherLayer.write(0x20, otherMessage) == 100);
+
+        // The abandoned fragment of the first address is not mixed into the message of the other
+        wire.insert(wire.begin(), frames[0].begin(), frames[0].end());
+
+        std::vector<uint8_t> buffer(100);
+        const auto response { receiverLayer->read(buffer) };
+        CHECK(response.size == 100);
+        CHECK(response.address == 0x20);
+        CHECK(buffer == otherMessage);
+    }
+
+    SECTION("Test read of a frame which is not a fragment")
+    {
+        uint8_t data[2] = { 0x01, 0x02 };
+        CHECK(sender->write(Hdlcpp::AddressBroadcast, data) > 0);
+
+        std::vector<uint8_t> buffer(16);
+        CHECK(receiverLayer->read(buffer).size == -EPROTO);
+    }
+}
@@ -0,0 +1,199 @@
+#include "turtle/catch.hpp"
+#include <catch.hpp>
+
+#define protected public
+#include "SyncHdlcpp.hpp"
+
+class SyncHdlcppFixture {
+public:
+    static constexpr uint16_t bufferSize = 64;
+
+    SyncHdlcppFixture()
+    {
+        hdlcpp = std::make_shared<Hdlcpp::SyncHdlcpp>(
+            [this](Hdlcpp::Container buffer) { return transportRead(buffer); },
+            [this](Hdlcpp::ConstContainer buffer) { return transportWrite(buffer); },
+            hdlcpp_readBuffer,
+            hdlcpp_writeBuffer,
+            1, // Use a 1 ms timeout to speed up tests
+            1);
+
+        // For testing only execute a single iteration instead of blocking
+        hdlcpp->stopped = true;
+    }
+
+    std::vector<uint8_t> encodeFrame(Hdlcpp::Hdlcpp::Frame frame, uint8_t sequenceNumber, Hdlcpp::ConstContainer data = {})
+    {
+        std::array<uint8_t, Hdlcpp::Calculate<bufferSize>::WithSyncOverhead> buffer {};
+        const int size = hdlcpp->encode(Hdlcpp::AddressBroadcast, frame, sequenceNumber, data, { buffer });
+
+        return { buffer.begin(), buffer.begin() + size };
+    }
+
+    // Prepends idle 1 bits so the frame is no longer aligned to a byte boundary
+    static std::vector<uint8_t> shift(const std::vector<uint8_t>& frame, uint8_t bits)
+    {
+        std::vector<uint8_t> shifted;
+        uint16_t value = (1 << bits) - 1;
+
+        for (const auto& byte : frame) {
+            value |= byte << bits;
+            shifted.push_back(value & 0xff);
+            value >>= 8;
+        }
+        shifted.push_back(value | (0xff << bits));
+
+        return shifted;
+    }
+
+    size_t transportRead(Hdlcpp::Container buffer)
+    {
+        std::memcpy(buffer.data(), readBuffer.data(), readBuffer.size());
+        return readBuffer.size();
+    }
+
+    size_t transportWrite(Hdlcpp::ConstContainer buffer)
+    {
+        writeBuffer.assign(buffer.begin(), buffer.end());
+        return writeBuffer.size();
+    }
+
+    std::shared_ptr<Hdlcpp::SyncHdlcpp> hdlcpp;
+    Hdlcpp::StaticBuffer<Hdlcpp::Calculate<bufferSize>::WithSyncOverhead> hdlcpp_readBuffer {};
+    Hdlcpp::StaticBuffer<Hdlcpp::Calculate<bufferSize>::WithSyncOverhead> hdlcpp_writeBuffer {};
+    std::vector<uint8_t> readBuffer;
+    std::vector<uint8_t> writeBuffer;
+    uint8_t dataBuffer[bufferSize];
+};
+
+TEST_CASE_METHOD(SyncHdlcppFixture, "sync hdlcpp test", "[single-file]")
+{
+    SECTION("Test stuff/destuff tables")
+    {
+        // Five 1 bits get a 0 bit inserted
+        CHECK(Hdlcpp::SyncHdlcpp::StuffTable[0][0x1f].bits == 0x1f);
+        CHECK(Hdlcpp::SyncHdlcpp::StuffTable[0][0x1f].size == 9);
+        CHECK(Hdlcpp::SyncHdlcpp::StuffTable[0][0xff].size == 9);
+        CHECK(Hdlcpp::SyncHdlcpp::StuffTable[4][0xff].size == 10);
+        CHECK(Hdlcpp::SyncHdlcpp::StuffTable[0][0xff].ones == 3);
+        // The inserted 0 bit is deleted
+        CHECK(Hdlcpp::SyncHdlcpp::DestuffTable[0][0x1f].bits == 0x1f);
+        CHECK(Hdlcpp::SyncHdlcpp::DestuffTable[0][0x1f].size == 7);
+        CHECK(Hdlcpp::SyncHdlcpp::DestuffTable[5][0x02].bits == 0x3f);
+        CHECK(Hdlcpp::SyncHdlcpp::DestuffTable[5][0x02].size == 12);
+        // 1 bits are pending until it is known they are not part of a flag sequence
+        CHECK(Hdlcpp::SyncHdlcpp::DestuffTable[0][0xe0].size == 5);
+        CHECK(Hdlcpp::SyncHdlcpp::DestuffTable[0][0xe0].ones == 3);
+        // Six 1 bits are decoded a bit at a time
+        CHECK(Hdlcpp::SyncHdlcpp::DestuffTable[0][Hdlcpp::Hdlcpp::FlagSequence].ones == Hdlcpp::BitStuffing::Event);
+    }
+
+    SECTION("Test write/read with 1 byte data input")
+    {
+        const uint8_t data[1] = { 0x55 };
+
+        hdlcpp->write(Hdlcpp::AddressBroadcast, data);
+        CHECK(writeBuffer == encodeFrame(Hdlcpp::Hdlcpp::FrameData, 1, data));
+
+        readBuffer = writeBuffer;
+        CHECK(hdlcpp->read(dataBuffer).size == 1);
+        CHECK(dataBuffer[0] == data[0]);
+        // The data frame is acknowledged
+        CHECK(writeBuffer == encodeFrame(Hdlcpp::Hdlcpp::FrameAck, 2));
+    }
+
+    SECTION("Test encode/decode with worst case data input")
+    {
+        std::vector<uint8_t> data(bufferSize, 0xff);
+        // Address and FCS of all 1 bits as well for the worst case overhead
+        std::array<uint8_t, Hdlcpp::Calculate<bufferSize>::WithSyncOverhead> buffer {};
+        Hdlcpp::Hdlcpp::Frame frame = Hdlcpp::Hdlcpp::FrameData;
+        Hdlcpp::TransportAddress address = 0;
+        uint8_t sequenceNumber = 7;
+        uint16_t discardBytes = 0;
+
+        const int size = hdlcpp->encode(0xff, frame, sequenceNumber, data, { buffer });
+        CHECK(size > static_cast<int>(data.size() * 6 / 5));
+        CHECK(size <= static_cast<int>(buffer.size()));
+        CHECK(hdlcpp->decode(address, frame, sequenceNumber, std::span(buffer).first(size), dataBuffer, discardBytes) == bufferSize);
+        CHECK(std::equal(data.begin(), data.end(), dataBuffer));
+        CHECK(address == 0xff);
+        CHECK(frame == Hdlcpp::Hdlcpp::FrameData);
+        CHECK(sequenceNumber == 7);
+        // The closing flag sequence is kept (it is not aligned to a byte boundary)
+        CHECK(discardBytes == (size - 2));
+    }
+
+    SECTION("Test encode buffer too small")
+    {
+        std::vector<uint8_t> data(bufferSize, 0xff);
+        std::array<uint8_t, Hdlcpp::Calculate<bufferSize>::WithSyncOverhead> buffer {};
+        Hdlcpp::Hdlcpp::Frame frame = Hdlcpp::Hdlcpp::FrameData;
+        uint8_t sequenceNumber = 0;
+
+        const int size = hdlcpp->encode(0xff, frame, sequenceNumber, data, { buffer });
+        CHECK(hdlcpp->encode(0xff, frame, sequenceNumber, data, std::span(buffer).first(size - 1)) == -EINVAL);
+    }
+
+    SECTION("Test read of a data frame not aligned to a byte boundary")
+    {
+        const uint8_t data[3] = { 0x7e, 0x7d, 0xff };
+        const uint8_t bits { GENERATE(range<uint8_t>(0, 8)) };
+
+        readBuffer = shift(encodeFrame(Hdlcpp::Hdlcpp::FrameData, 1, data), bits);
+        CHECK(hdlcpp->read(dataBuffer).size == sizeof(data));
+        CHECK(std::memcmp(dataBuffer, data, sizeof(data)) == 0);
+    }
+
+    SECTION("Test read of two data frames")
+    {
+        const uint8_t data[2] = { 0x11, 0x22 };
+
+        readBuffer = encodeFrame(Hdlcpp::Hdlcpp::FrameData, 1, { &data[0], 1 });
+        const auto second { shift(encodeFrame(Hdlcpp::Hdlcpp::FrameData, 2, { &data[1], 1 }), 3) };
+        readBuffer.insert(readBuffer.end(), second.begin(), second.end());
+
+        CHECK(hdlcpp->read(dataBuffer).size == 1);
+        CHECK(dataBuffer[0] == data[0]);
+        readBuffer.clear();
+        CHECK(hdlcpp->read(dataBuffer).size == 1);
+        CHECK(dataBuffer[0] == data[1]);
+    }
+
+    SECTION("Test read of an invalid data frame")
+    {
+        const uint8_t data[1] = { 0x55 };
+
+        readBuffer = encodeFrame(Hdlcpp::Hdlcpp::FrameData, 1, data);
+        readBuffer[3] ^= 0x01;
+        CHECK(hdlcpp->read(dataBuffer).size == -EIO);
+        // The data frame is negative acknowledged
+        CHECK(writeBuffer == encodeFrame(Hdlcpp::Hdlcpp::FrameNack, 1));
+    }
+
+    SECTION("Test read of an aborted data frame")
+    {
+        const uint8_t data[1] = { 0x55 };
+
+        // Seven 1 bits abort the frame
+        readBuffer = encodeFrame(Hdlcpp::Hdlcpp::FrameData, 1, data);
+        readBuffer[2] = 0xff;
+        readBuffer[3] = 0xff;
+        CHECK(hdlcpp->read(dataBuffer).size == -ENOMSG);
+    }
+
+    SECTION("Test read of ack frame")
+    {
+        readBuffer = encodeFrame(Hdlcpp::Hdlcpp::FrameAck, 1);
+        CHECK(hdlcpp->read(dataBuffer).size == 0);
+        CHECK(hdlcpp->writeResult == Hdlcpp::Hdlcpp::FrameAck);
+    }
+
+    SECTION("Test read of data frame larger than the buffer")
+    {
+        const uint8_t data[2] = { 0x11, 0x22 };
+
+        readBuffer = encodeFrame(Hdlcpp::Hdlcpp::FrameData, 1, data);
+        CHECK(hdlcpp->read({ dataBuffer, 1 }).size == -EMSGSIZE);
+    }
+}
@@ -0,0 +1,238 @@
+#include "CaptureDecoder.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <mutex>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+// Decodes a raw capture of a link (e.g. a multi-GB UART dump) on all cores. The memory mapped capture is
+// split into chunks at flag sequences, the chunks are decoded in parallel and the frames are written in order.
+
+static constexpr char binaryMagic[8] = { 'H', 'D', 'L', 'C', 'C', 'A', 'P', 1 };
+
+struct Options {
+    bool binary { false };
+    unsigned threads { std::max(1u, std::thread::hardware_concurrency()) };
+    size_t chunkSize { 4 << 20 };
+    size_t maxPayload { 4096 };
+    const char* input { nullptr };
+    const char* output { nullptr };
+};
+
+struct Chunk {
+    std::string output;
+    size_t frames { 0 };
+    size_t errors { 0 };
+    bool done { false };
+};
+
+static void usage(const char* name)
+{
+    std::fprintf(stderr,
+        "Usage: %s [options] capture [output]\n"
+        "Options:\n"
+        "  -b               Write binary records instead of CSV\n"
+        "  -j <threads>     Number of decoding threads (default: number of cores)\n"
+        "  -c <bytes>       Chunk size (default: 4194304)\n"
+        "  -m <bytes>       Maximum payload size (default: 4096)\n"
+        "CSV columns: offset,length,status,address,frame,sequence,data\n"
+        "Binary: the magic \"HDLCCAP\\1\" and per frame a little endian record of offset (u64), length (u32),\n"
+        "status (i32), address (u8), frame (u8), sequence (u8), reserved (u8) and the payload (status bytes)\n"
+        "Binary frame values: 0 data, 1 ack, 2 nack, 3 rnr, 4 srej, 5 compressed data\n",
+        name);
+}
+
+static bool parse(int argc, char* argv[], Options& options)
+{
+    int option;
+
+    while ((option = getopt(argc, argv, "bj:c:m:h")) != -1) {
+        switch (option) {
+        case 'b':
+            options.binary = true;
+            break;
+        case 'j':
+            options.threads = std::max(1, std::atoi(optarg));
+            break;
+        case 'c':
+            options.chunkSize = std::max(1ll, std::atoll(optarg));
+            break;
+        case 'm':
+            options.maxPayload = std::max(1ll, std::atoll(optarg));
+            break;
+        default:
+            return false;
+        }
+    }
+
+    if ((optind >= argc) || ((argc - optind) > 2))
+        return false;
+
+    options.input = argv[optind];
+    options.output = ((argc - optind) == 2) ? argv[optind + 1] : nullptr;
+    return true;
+}
+
+template <typename T>
+static void append(std::string& output, T value)
+{
+    for (size_t i = 0; i < sizeof(value); i++)
+        output.push_back(static_cast<char>((static_cast<uint64_t>(value) >> (8 * i)) & 0xff));
+}
+
+static void appendRecord(std::string& output, const Hdlcpp::CaptureDecoder::Record& record, bool binary)
+{
+    static constexpr char hex[] = "0123456789abcdef";
+
+    if (binary) {
+        append<uint64_t>(output, record.offset);
+        append<uint32_t>(output, record.length);
+        append<int32_t>(output, record.status);
+        append<uint8_t>(output, record.address);
+        append<uint8_t>(output, record.frame);
+        append<uint8_t>(output, record.sequenceNumber);
+        append<uint8_t>(output, 0);
+        output.append(reinterpret_cast<const char*>(record.data.data()), record.data.size());
+        return;
+    }
+
+    const char* status = (record.status >= 0) ? "ok" : ((record.status == -EIO) ? "bad-fcs" : "too-large");
+    char fields[96];
+    std::snprintf(fields, sizeof(fields), "%llu,%u,%s,%u,%s,%u,", static_cast<unsigned long long>(record.offset), record.length,
+        status, record.address, Hdlcpp::CaptureDecoder::frameName(record.frame), record.sequenceNumber);
+    output += fields;
+
+    for (const auto& byte : record.data) {
+        output.push_back(hex[byte >> 4]);
+        output.push_back(hex[byte & 0xf]);
+    }
+    output.push_back('\n');
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+
+    if (!parse(argc, argv, options)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    const int fd = open(options.input, O_RDONLY);
+    struct stat status {};
+    if ((fd < 0) || (fstat(fd, &status) < 0)) {
+        std::fprintf(stderr, "Failed to open %s: %s\n", options.input, std::strerror(errno));
+        return 1;
+    }
+
+    const size_t size = status.st_size;
+    const uint8_t* data = nullptr;
+    if (size > 0) {
+        void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            std::fprintf(stderr, "Failed to map %s: %s\n", options.input, std::strerror(errno));
+            return 1;
+        }
+        madvise(mapping, size, MADV_SEQUENTIAL);
+        data = static_cast<const uint8_t*>(mapping);
+    }
+    close(fd);
+
+    FILE* output = options.output ? std::fopen(options.output, "wb") : stdout;
+    if (!output) {
+        std::fprintf(stderr, "Failed to open %s: %s\n", options.output, std::strerror(errno));
+        return 1;
+    }
+
+    const auto begin { std::chrono::steady_clock::now() };
+    const Hdlcpp::ConstContainer capture { data, size };
+    const size_t chunkCount = (size + options.chunkSize - 1) / options.chunkSize;
+    // Bounds the decoded output held in memory while waiting for an earlier chunk
+    const size_t maxChunksAhead = options.threads * 2;
+    std::vector<Chunk> chunks(chunkCount);
+    std::mutex mutex;
+    std::condition_variable condition;
+    size_t nextChunk = 0, written = 0;
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < std::min<size_t>(options.threads, chunkCount); i++) {
+        workers.emplace_back([&] {
+            std::vector<Hdlcpp::value_type> payloadBuffer(options.maxPayload);
+            Hdlcpp::CaptureDecoder decoder(payloadBuffer);
+
+            for (;;) {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [&] { return (nextChunk >= chunkCount) || (nextChunk < (written + maxChunksAhead)); });
+                if (nextChunk >= chunkCount)
+                    return;
+
+                Chunk& chunk = chunks[nextChunk];
+                const size_t nominal = nextChunk * options.chunkSize;
+                nextChunk++;
+                lock.unlock();
+
+                // Each chunk spans from a flag sequence to the flag sequence opening the next chunk (included)
+                const size_t start = (nominal == 0) ? 0 : Hdlcpp::CaptureDecoder::boundary(capture, nominal);
+                const size_t stop = std::min(Hdlcpp::CaptureDecoder::boundary(capture, nominal + options.chunkSize) + 1, size);
+                Chunk result;
+
+                if (start < stop) {
+                    result.frames = decoder.decodeFrames(capture.subspan(start, stop - start), start, [&](const Hdlcpp::CaptureDecoder::Record& record) {
+                        result.errors += (record.status < 0);
+                        appendRecord(result.output, record, options.binary);
+                    });
+                }
+
+                lock.lock();
+                chunk = std::move(result);
+                chunk.done = true;
+                lock.unlock();
+                condition.notify_all();
+            }
+        });
+    }
+
+    size_t frames = 0, errors = 0;
+    if (options.binary)
+        std::fwrite(binaryMagic, 1, sizeof(binaryMagic), output);
+
+    while (written < chunkCount) {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [&] { return chunks[written].done; });
+        Chunk chunk = std::move(chunks[written]);
+        lock.unlock();
+
+        std::fwrite(chunk.output.data(), 1, chunk.output.size(), output);
+        frames += chunk.frames;
+        errors += chunk.errors;
+
+        lock.lock();
+        written++;
+        lock.unlock();
+        condition.notify_all();
+    }
+
+    for (auto& worker : workers)
+        worker.join();
+
+    if (output != stdout)
+        std::fclose(output);
+    else
+        std::fflush(output);
+
+    const auto seconds { std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count() };
+    std::fprintf(stderr, "%zu frames (%zu with errors) in %zu bytes, %.3f s (%.1f MB/s)\n", frames, errors, size, seconds,
+        (seconds > 0) ? size / seconds / 1e6 : 0.0);
+
+    if (data)
+        munmap(const_cast<uint8_t*>(data), size);
+
+    return 0;
+}